@@ -0,0 +1,388 @@
+/******************************************************************************/
+/*!
+\file   active.cpp
+\author Isaac Hill
+\par    email: Isaac.Hill@digipen.edu
+\par    DigiPen login: Isaac.Hill
+\par    Course: CS355
+\par    Assignment #1
+\date   1/21/2020
+\brief
+This is the Implementation file for the active region game of life engine,
+which only steps the small tiles that could have changed since the last
+generation
+*/
+/******************************************************************************/
+
+#include "simulation.h"
+#include "grid.h"
+#include "pool.h"
+
+namespace
+{
+	int const kTilesPerTask = 4; // tiles from one row handed out together by work stealing
+
+	/******************************************************************************/
+	/*!
+	Two byte grids cut into small square tiles. A tile is only stepped when it
+	or one of its 8 neighbor tiles changed in the last generation. A skipped
+	tile did not change last generation, so the grid being written already
+	holds its current cells and nothing has to be copied. With work stealing
+	short runs of tiles are the tasks, so a worker that runs out of busy tiles
+	helps the ones that still have some.
+	*/
+	/******************************************************************************/
+	class ActiveSimulation : public Simulation
+	{
+	public:
+		ActiveSimulation(BoardView const& initial, Options const& options);
+
+		void Advance(int generations);
+		std::vector< std::tuple<int, int> > Result() const;
+		void GetStats(Stats* stats) const;
+		uint64_t Hash() const { return HashBoard(grids_[current_]); }
+		bool Alive(int x, int y) const { return grids_[current_].Row(y)[x] != 0; }
+		void ForEachLive(std::function<void(int, int)> const& visit) const { ::ForEachLive(grids_[current_], visit); }
+
+	private:
+		void Step(int worker, int generations);
+		void StepStealing(int worker, int generations);
+		bool StepTile(ByteGrid const& from, ByteGrid* to, int tile_x, int tile_y);
+		bool NeighborhoodChanged(std::vector<uint8_t> const& changed, int tile_x, int tile_y) const;
+
+		ByteGrid grids_[2];
+		std::vector<uint8_t> changed_[2]; // per tile, did it change in the step that wrote grids_[i]
+		int current_;
+		int tile_size_;
+		int tiles_x_;
+		int tiles_y_;
+		std::vector<long long> active_; // per worker count of tiles stepped
+		long long total_;
+		Scheduling scheduling_;
+		Rule rule_;
+		Boundary boundary_;
+		WorkerPool pool_;
+		Barrier barrier_;
+		TaskQueues tasks_;
+	};
+
+	/******************************************************************************/
+	/*!
+	Creates both grids and marks every tile as changed so the first generation
+	steps all of them
+
+	\param initial
+	Board to start from
+
+	\param options
+	Thread count, tile size, scheduling, rule and boundary to use
+	*/
+	/******************************************************************************/
+	ActiveSimulation::ActiveSimulation(BoardView const& initial, Options const& options)
+		: Simulation(initial.Width(), initial.Height()),
+		  current_(0),
+		  tile_size_(options.active_tile_size > 0 ? options.active_tile_size : 32),
+		  tiles_x_((initial.Width() + tile_size_ - 1) / tile_size_),
+		  tiles_y_((initial.Height() + tile_size_ - 1) / tile_size_),
+		  total_(0),
+		  scheduling_(options.scheduling),
+		  rule_(options.rule),
+		  boundary_(options.boundary),
+		  pool_(options.num_threads, options.numa),
+		  barrier_(pool_.Size(), options.barrier),
+		  tasks_(pool_.Size())
+	{
+		grids_[0] = CreateByteGrid(initial);
+		grids_[1] = ByteGrid(initial.Width(), initial.Height());
+		if (boundary_ == Boundary::kWrap)
+		{
+			WrapBorder(&grids_[0], 0, initial.Width(), 0, initial.Height());
+		}
+		changed_[0].assign(tiles_x_ * tiles_y_, 1);
+		changed_[1].assign(tiles_x_ * tiles_y_, 1);
+		active_.assign(pool_.Size(), 0);
+		tracer_.Start(pool_.Size());
+	}
+
+	/******************************************************************************/
+	/*!
+	Steps the grid on every worker
+
+	\param generations
+	Number of generations to step
+	*/
+	/******************************************************************************/
+	void ActiveSimulation::Advance(int generations)
+	{
+		if (generations <= 0 || tiles_x_ * tiles_y_ == 0)
+		{
+			return;
+		}
+
+		if (scheduling_ == Scheduling::kWorkStealing)
+		{
+			pool_.Run([this, generations](int worker) { StepStealing(worker, generations); });
+		}
+		else
+		{
+			pool_.Run([this, generations](int worker) { Step(worker, generations); });
+		}
+
+		current_ = (current_ + generations) % 2;
+		total_ += static_cast<long long>(generations) * tiles_x_ * tiles_y_;
+	}
+
+	/******************************************************************************/
+	/*!
+	Checks the 3x3 tiles around a tile, on a torus the tiles along the edges
+	are next to the ones on the other side
+
+	\param changed
+	Change flags of the last generation
+
+	\param tile_x, tile_y
+	Tile in the middle
+
+	\return
+	If any of them changed
+	*/
+	/******************************************************************************/
+	bool ActiveSimulation::NeighborhoodChanged(std::vector<uint8_t> const& changed, int tile_x, int tile_y) const
+	{
+		bool const wrap = boundary_ == Boundary::kWrap;
+
+		for (int dy = -1; dy <= 1; ++dy)
+		{
+			int y = tile_y + dy;
+			if (wrap)
+			{
+				y = (y + tiles_y_) % tiles_y_;
+			}
+			else if (y < 0 || y >= tiles_y_)
+			{
+				continue;
+			}
+
+			for (int dx = -1; dx <= 1; ++dx)
+			{
+				int x = tile_x + dx;
+				if (wrap)
+				{
+					x = (x + tiles_x_) % tiles_x_;
+				}
+				else if (x < 0 || x >= tiles_x_)
+				{
+					continue;
+				}
+
+				if (changed[y * tiles_x_ + x])
+				{
+					return true;
+				}
+			}
+		}
+
+		return false;
+	}
+
+	/******************************************************************************/
+	/*!
+	Steps one tile and compares it with the generation before. A tile that is
+	not stepped keeps the cells and the wrapped border it wrote two
+	generations ago, which are still right since nothing near it changed.
+
+	\param from
+	Grid in the current generation
+
+	\param to
+	Grid that receives the next generation
+
+	\param tile_x, tile_y
+	Tile to step
+
+	\return
+	If any cell of the tile changed
+	*/
+	/******************************************************************************/
+	bool ActiveSimulation::StepTile(ByteGrid const& from, ByteGrid* to, int tile_x, int tile_y)
+	{
+		int const x0 = tile_x * tile_size_;
+		int const y0 = tile_y * tile_size_;
+		int const x1 = x0 + tile_size_ < from.Width() ? x0 + tile_size_ : from.Width();
+		int const y1 = y0 + tile_size_ < from.Height() ? y0 + tile_size_ : from.Height();
+
+		bool const changed = StepGridRect(from, to, x0, x1, y0, y1, rule_);
+		if (boundary_ == Boundary::kWrap)
+		{
+			WrapBorder(to, x0, x1, y0, y1);
+		}
+
+		return changed;
+	}
+
+	/******************************************************************************/
+	/*!
+	Main logic for one worker, rows of tiles are dealt out round robin so a
+	busy region is spread over several workers
+
+	\param worker
+	Index of the worker
+
+	\param generations
+	Number of generations to step
+	*/
+	/******************************************************************************/
+	void ActiveSimulation::Step(int worker, int generations)
+	{
+		int const num_workers = pool_.Size();
+		int current = current_;
+		long long active = 0;
+
+		for (int i = 0; i < generations; ++i)
+		{
+			ByteGrid const& from = grids_[current];
+			ByteGrid& to = grids_[1 - current];
+			std::vector<uint8_t> const& last = changed_[current];
+			std::vector<uint8_t>& next = changed_[1 - current];
+
+			{
+				GOL_TRACE_PHASE(&tracer_, worker, Phase::kCompute, i);
+				for (int tile_y = worker; tile_y < tiles_y_; tile_y += num_workers)
+				{
+					for (int tile_x = 0; tile_x < tiles_x_; ++tile_x)
+					{
+						bool changed = false;
+						if (NeighborhoodChanged(last, tile_x, tile_y))
+						{
+							changed = StepTile(from, &to, tile_x, tile_y);
+							++active;
+						}
+						next[tile_y * tiles_x_ + tile_x] = changed;
+					}
+				}
+			}
+
+			current = 1 - current;
+
+			{
+				GOL_TRACE_PHASE(&tracer_, worker, Phase::kBarrier, i);
+				barrier_.Wait(worker);
+			}
+		}
+
+		active_[worker] += active;
+	}
+
+	/******************************************************************************/
+	/*!
+	Main logic for one worker with work stealing. Each worker refills its own
+	queue right after the barrier, a worker that gets there first may find the
+	others still empty and go straight to the next barrier, which is harmless.
+
+	\param worker
+	Index of the worker
+
+	\param generations
+	Number of generations to step
+	*/
+	/******************************************************************************/
+	void ActiveSimulation::StepStealing(int worker, int generations)
+	{
+		int const runs_x = (tiles_x_ + kTilesPerTask - 1) / kTilesPerTask;
+		int current = current_;
+		long long active = 0;
+
+		for (int i = 0; i < generations; ++i)
+		{
+			ByteGrid const& from = grids_[current];
+			ByteGrid& to = grids_[1 - current];
+			std::vector<uint8_t> const& last = changed_[current];
+			std::vector<uint8_t>& next = changed_[1 - current];
+
+			{
+				GOL_TRACE_PHASE(&tracer_, worker, Phase::kCompute, i);
+				tasks_.Reset(worker, runs_x * tiles_y_);
+
+				int task;
+				while (tasks_.Next(worker, &task))
+				{
+					//Each task is a short run of tiles from one row of tiles
+					int const tile_y = task / runs_x;
+					int const first = (task % runs_x) * kTilesPerTask;
+					int const end = first + kTilesPerTask < tiles_x_ ? first + kTilesPerTask : tiles_x_;
+
+					for (int tile_x = first; tile_x < end; ++tile_x)
+					{
+						bool changed = false;
+						if (NeighborhoodChanged(last, tile_x, tile_y))
+						{
+							changed = StepTile(from, &to, tile_x, tile_y);
+							++active;
+						}
+						next[tile_y * tiles_x_ + tile_x] = changed;
+					}
+				}
+			}
+
+			current = 1 - current;
+
+			{
+				GOL_TRACE_PHASE(&tracer_, worker, Phase::kBarrier, i);
+				barrier_.Wait(worker);
+			}
+		}
+
+		active_[worker] += active;
+	}
+
+	/******************************************************************************/
+	/*!
+	Gets coordinates of all live spaces on board
+
+	\return
+	All coordinates of live spaces on board
+	*/
+	/******************************************************************************/
+	std::vector< std::tuple<int, int> > ActiveSimulation::Result() const
+	{
+		return GetResult(grids_[current_]);
+	}
+
+	/******************************************************************************/
+	/*!
+	Reports how many tiles were stepped
+
+	\param stats
+	Receives the active and total tile counts
+	*/
+	/******************************************************************************/
+	void ActiveSimulation::GetStats(Stats* stats) const
+	{
+		stats->active_tiles = 0;
+		for (unsigned i = 0; i < active_.size(); ++i)
+		{
+			stats->active_tiles += active_[i];
+		}
+		stats->total_tiles = total_;
+		stats->steals = tasks_.Steals();
+	}
+}
+
+/******************************************************************************/
+/*!
+Creates the active region engine
+
+\param initial
+Board to start from
+
+\param options
+Thread count and tile size to use
+
+\return
+Newly allocated simulation, owned by the caller
+*/
+/******************************************************************************/
+Simulation* CreateActiveSimulation(BoardView const& initial, Options const& options)
+{
+	return new ActiveSimulation(initial, options);
+}
@@ -0,0 +1,84 @@
+/******************************************************************************/
+/*!
+\file   async.cpp
+\author Isaac Hill
+\par    email: Isaac.Hill@digipen.edu
+\par    DigiPen login: Isaac.Hill
+\par    Course: CS355
+\par    Assignment #1
+\date   1/21/2020
+\brief
+This is the Implementation file for the handle of a background run
+*/
+/******************************************************************************/
+
+#include "async.h"
+
+/******************************************************************************/
+/*!
+Creates the handle of a run that was started
+
+\param progress
+State shared with the run
+
+\param result
+Receives the live cells once the run is over
+*/
+/******************************************************************************/
+RunHandle::RunHandle(std::shared_ptr<RunProgress> progress, std::future< std::vector< std::tuple<int, int> > > result)
+	: progress_(std::move(progress)), result_(std::move(result))
+{
+}
+
+/******************************************************************************/
+/*!
+Move constructor
+
+\param rhs
+Handle to take over, it no longer refers to the run
+*/
+/******************************************************************************/
+RunHandle::RunHandle(RunHandle&& rhs) : progress_(std::move(rhs.progress_)), result_(std::move(rhs.result_))
+{
+}
+
+/******************************************************************************/
+/*!
+Cancels the run if it is still going and waits for it to stop
+*/
+/******************************************************************************/
+RunHandle::~RunHandle()
+{
+	if (result_.valid())
+	{
+		cancel();
+		result_.wait();
+	}
+}
+
+/******************************************************************************/
+/*!
+Sets the flag the run checks between runs of generations, does nothing on
+a handle that was moved from
+*/
+/******************************************************************************/
+void RunHandle::cancel()
+{
+	if (progress_)
+	{
+		progress_->cancelled.store(true, std::memory_order_relaxed);
+	}
+}
+
+/******************************************************************************/
+/*!
+Waits for the run to be over
+
+\return
+Live cells of the board after generation() generations
+*/
+/******************************************************************************/
+std::vector< std::tuple<int, int> > RunHandle::get()
+{
+	return result_.get();
+}
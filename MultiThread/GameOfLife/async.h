@@ -0,0 +1,84 @@
+/******************************************************************************/
+/*!
+\file   async.h
+\author Isaac Hill
+\par    email: Isaac.Hill@digipen.edu
+\par    DigiPen login: Isaac.Hill
+\par    Course: CS355
+\par    Assignment #1
+\date   1/21/2020
+\brief
+This is the Header file for running a simulation in the background. The
+caller gets a handle it can poll, wait on with a timeout or cancel, and the
+run stops at the next generation boundary it checks without tearing down
+any worker thread.
+*/
+/******************************************************************************/
+
+#ifndef ASYNC_H
+#define ASYNC_H
+
+#include "gol.h"
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+// Shared between a background run and its handle
+struct RunProgress
+{
+	RunProgress() : cancelled(false), generation(0) {}
+
+	std::atomic<bool> cancelled;       // set by the handle, read between runs of generations
+	std::atomic<long long> generation; // generations stepped so far, written between runs of generations
+};
+
+/******************************************************************************/
+/*!
+Handle to a run started by run_async. Dropping the handle cancels the run
+and waits for it to stop. A handle that was moved from no longer refers to
+any run, cancel does nothing and generation is 0, but wait_for and get must
+not be called on it.
+*/
+/******************************************************************************/
+class RunHandle
+{
+public:
+	RunHandle(std::shared_ptr<RunProgress> progress, std::future< std::vector< std::tuple<int, int> > > result);
+	RunHandle(RunHandle&& rhs);
+	~RunHandle();
+
+	// Asks the run to stop, it does so at the next generation boundary it checks
+	void cancel();
+
+	// Generations stepped so far
+	long long generation() const { return progress_ ? progress_->generation.load(std::memory_order_relaxed) : 0; }
+
+	// Waits until the run is over or the timeout passes, like std::future::wait_for
+	template <typename Rep, typename Period>
+	std::future_status wait_for(std::chrono::duration<Rep, Period> const& timeout) const { return result_.wait_for(timeout); }
+
+	// Waits for the run and gives the live cells of the board it stopped at, after
+	// generation() generations, throws what the run threw
+	std::vector< std::tuple<int, int> > get();
+
+private:
+	RunHandle(RunHandle const&);
+	RunHandle& operator=(RunHandle const&);
+
+	std::shared_ptr<RunProgress> progress_;
+	std::future< std::vector< std::tuple<int, int> > > result_;
+};
+
+// Same as run, on a thread of its own. The engine is built from the initial board
+// before the call returns, so the board need not outlive it, but stats and the
+// trace_file string must outlive the run. The trace is written when the run stops,
+// cancelled or not. The observer, checkpoint and detect_cycles options are not used.
+RunHandle run_async(BoardView const& initial, int num_iter, Options const& options);
+RunHandle run_async(std::vector< std::tuple<int, int> > const& initial_population, int num_iter, int max_x, int max_y,
+                    Options const& options);
+
+#endif
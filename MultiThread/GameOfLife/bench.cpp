@@ -0,0 +1,588 @@
+/******************************************************************************/
+/*!
+\file   bench.cpp
+\author Isaac Hill
+\par    email: Isaac.Hill@digipen.edu
+\par    DigiPen login: Isaac.Hill
+\par    Course: CS355
+\par    Assignment #1
+\date   1/21/2020
+\brief
+Benchmark for the game of life engines. Random boards of every size,
+density and layout are run on every engine and thread count, and cells per
+second, per generation latency percentiles and peak memory are written out
+as CSV or JSON. Cells per second come from a plain run, the latencies from
+a second run stopped after every generation. Each configuration happens in
+its own child process so the peak memory it reports is its own.
+
+usage: bench.exe [--sizes=64,256,1024] [--densities=0.1,0.35]
+                 [--layouts=uniform,clustered]
+                 (uniform fills the whole board at the density, clustered
+                 only a square an eighth of the side in one corner, which
+                 leaves most workers of a static schedule idle)
+                 [--generations=100] [--threads=1,4] [--seed=1]
+                 [--engines=tiled,tiled-double,bitpacked,simd,hashlife,active,active-stealing,sparse,lookup]
+                 (tiled updates the board in place, tiled-double double
+                 buffers it, active-stealing is the active engine with the
+                 work stealing scheduler, percell and sharded can also be
+                 named, for sharded the thread count is the number of
+                 processes, ensemble runs --boards random boards of each size through
+                 run_ensemble and reports boards per second instead of
+                 latencies)
+                 [--boards=1000] [--rule=B3/S23] [--numa] [--json]
+                 (--numa pins the workers and places each band on the node
+                 of its worker, local_pages and remote_pages are added to
+                 the output for the engines that report them)
+*/
+/******************************************************************************/
+
+#include "gol.h"
+#include "pattern.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace
+{
+	// One line of output
+	struct Result
+	{
+		double seconds;
+		double cells_per_second;
+		double boards_per_second; // only for ensemble rows
+		double p50_us, p90_us, p99_us, max_us; // only for single board rows
+		long peak_rss_kb;
+		long long local_pages, remote_pages;
+	};
+
+	struct EngineName
+	{
+		char const* name;
+		Engine engine;
+		Buffering buffering;   // only used by the tiled engine
+		Scheduling scheduling; // only used by the active engine
+		bool ensemble;       // many boards through run_ensemble instead of one through run
+	};
+
+	EngineName const kEngines[] =
+	{
+		{ "percell", Engine::kPerCell, Buffering::kInPlace, Scheduling::kStatic, false },
+		{ "tiled", Engine::kTiled, Buffering::kInPlace, Scheduling::kStatic, false },
+		{ "tiled-double", Engine::kTiled, Buffering::kDoubleBuffered, Scheduling::kStatic, false },
+		{ "bitpacked", Engine::kBitPacked, Buffering::kInPlace, Scheduling::kStatic, false },
+		{ "simd", Engine::kSimd, Buffering::kInPlace, Scheduling::kStatic, false },
+		{ "hashlife", Engine::kHashLife, Buffering::kInPlace, Scheduling::kStatic, false },
+		{ "active", Engine::kActive, Buffering::kInPlace, Scheduling::kStatic, false },
+		{ "active-stealing", Engine::kActive, Buffering::kInPlace, Scheduling::kWorkStealing, false },
+		{ "sparse", Engine::kSparse, Buffering::kInPlace, Scheduling::kStatic, false },
+		{ "sharded", Engine::kSharded, Buffering::kInPlace, Scheduling::kStatic, false },
+		{ "lookup", Engine::kLookup, Buffering::kInPlace, Scheduling::kStatic, false },
+		{ "ensemble", Engine::kBitPacked, Buffering::kInPlace, Scheduling::kStatic, true }
+	};
+
+	/******************************************************************************/
+	/*!
+	Splits a comma separated list
+
+	\param list
+	Text to split
+
+	\return
+	The items
+	*/
+	/******************************************************************************/
+	std::vector<std::string> Split(char const* list)
+	{
+		std::vector<std::string> result;
+		std::string item;
+		for (char const* c = list; ; ++c)
+		{
+			if (*c == ',' || *c == 0)
+			{
+				if (!item.empty())
+				{
+					result.push_back(item);
+				}
+				item.clear();
+
+				if (*c == 0)
+				{
+					break;
+				}
+			}
+			else
+			{
+				item += *c;
+			}
+		}
+
+		return result;
+	}
+
+	/******************************************************************************/
+	/*!
+	Creates a random square board, the same seed always gives the same board
+
+	\param size
+	Width and height of the board
+
+	\param density
+	Chance of each cell being alive
+
+	\param seed
+	Seed of the generator
+
+	\param clustered
+	Only fill a square an eighth of the side in the top left corner, the
+	rest of the board is dead
+
+	\return
+	The board
+	*/
+	/******************************************************************************/
+	Pattern RandomBoard(int size, double density, uint64_t seed, bool clustered)
+	{
+		Pattern result(size, size);
+
+		uint64_t state = seed * 0x9e3779b97f4a7c15ULL + 1;
+		uint64_t const threshold = static_cast<uint64_t>(density * 18446744073709551615.0);
+		int const extent = clustered ? std::max(1, size / 8) : size;
+
+		for (int y = 0; y < extent; ++y)
+		{
+			for (int x = 0; x < extent; ++x)
+			{
+				//xorshift64*
+				state ^= state >> 12;
+				state ^= state << 25;
+				state ^= state >> 27;
+				if (state * 0x2545f4914f6cdd1dULL < threshold)
+				{
+					result.Set(x, y);
+				}
+			}
+		}
+
+		return result;
+	}
+
+	/******************************************************************************/
+	/*!
+	Runs one configuration twice. The first run is a plain run, so every
+	engine steps all the generations in one call the way it would for a
+	caller, and gives cells per second. The second run is stopped after
+	every generation to time each one, its first generation also pays for
+	creating the engine and its threads, so it is only a warm up and the
+	clock starts when it ends.
+
+	\param options
+	Engine and thread count
+
+	\param board
+	Board to start from
+
+	\param generations
+	Number of generations to time
+
+	\return
+	Timings of the run, the peak memory is filled in by the caller
+	*/
+	/******************************************************************************/
+	Result Measure(Options options, Pattern const& board, int generations)
+	{
+		typedef std::chrono::steady_clock Clock;
+
+		Stats stats;
+		options.stats = &stats;
+
+		Clock::time_point const run_start = Clock::now();
+		run(board, generations, options);
+		Clock::time_point const run_end = Clock::now();
+
+		Result result = {};
+		result.local_pages = stats.local_pages;
+		result.remote_pages = stats.remote_pages;
+		result.seconds = std::chrono::duration<double>(run_end - run_start).count();
+		result.cells_per_second = result.seconds > 0 ? static_cast<double>(board.Width()) * board.Height() * generations / result.seconds : 0;
+
+		std::vector<double> latencies;
+		latencies.reserve(generations);
+		Clock::time_point last;
+
+		options.stats = 0;
+		options.observe_every = 1;
+		options.observer = [&latencies, &last](long long generation, BoardView const&)
+		{
+			Clock::time_point const now = Clock::now();
+			if (generation > 1)
+			{
+				latencies.push_back(std::chrono::duration<double, std::micro>(now - last).count());
+			}
+			last = now;
+		};
+
+		run(board, generations + 1, options);
+
+		std::sort(latencies.begin(), latencies.end());
+		if (!latencies.empty())
+		{
+			size_t const n = latencies.size();
+			result.p50_us = latencies[n * 50 / 100];
+			result.p90_us = latencies[n * 90 / 100];
+			result.p99_us = latencies[n * 99 / 100];
+			result.max_us = latencies[n - 1];
+		}
+
+		return result;
+	}
+
+	/******************************************************************************/
+	/*!
+	Runs many random boards through run_ensemble and times the whole batch,
+	there is no per generation latency to report
+
+	\param options
+	Thread count
+
+	\param size, density, seed, clustered
+	Boards to generate, board i uses seed + i
+
+	\param generations
+	Number of generations to run
+
+	\param boards
+	Number of boards
+
+	\return
+	Timings of the run, cells per second counts the cells of every board and
+	boards per second counts whole boards run all the generations
+	*/
+	/******************************************************************************/
+	Result MeasureEnsemble(Options const& options, int size, double density, uint64_t seed, bool clustered, int generations,
+	                       int boards)
+	{
+		std::vector< std::vector< std::tuple<int, int> > > populations(boards);
+		for (int i = 0; i < boards; ++i)
+		{
+			std::vector< std::tuple<int, int> >& population = populations[i];
+			RandomBoard(size, density, seed + i, clustered).ForEachLive([&population](int x, int y) { population.push_back(std::make_tuple(x, y)); });
+		}
+
+		std::chrono::steady_clock::time_point const start = std::chrono::steady_clock::now();
+		run_ensemble(populations, generations, size, size, options);
+		std::chrono::steady_clock::time_point const end = std::chrono::steady_clock::now();
+
+		Result result = {};
+		result.seconds = std::chrono::duration<double>(end - start).count();
+		result.cells_per_second = result.seconds > 0 ? static_cast<double>(size) * size * generations * boards / result.seconds : 0;
+		result.boards_per_second = result.seconds > 0 ? boards / result.seconds : 0;
+
+		return result;
+	}
+
+	/******************************************************************************/
+	/*!
+	Formats one field of the output
+
+	\param format
+	printf format of the value
+
+	\param value
+	Value to format
+
+	\param present
+	False if the field does not apply to the row
+
+	\param json
+	Whether the output is JSON
+
+	\return
+	The value, or an empty CSV field or a JSON null if it does not apply
+	*/
+	/******************************************************************************/
+	std::string Field(char const* format, double value, bool present, bool json)
+	{
+		if (!present)
+		{
+			return json ? "null" : "";
+		}
+
+		char text[64];
+		std::snprintf(text, sizeof(text), format, value);
+		return text;
+	}
+
+	/******************************************************************************/
+	/*!
+	Runs one configuration in a child process so its memory use is measured
+	on its own
+
+	\param options
+	Engine and thread count
+
+	\param size, density, seed, clustered
+	Board to generate
+
+	\param generations
+	Number of generations to run
+
+	\param boards
+	Number of boards for run_ensemble, 0 for a single board through run
+
+	\param result
+	Receives the timings
+
+	\return
+	False if the child failed
+	*/
+	/******************************************************************************/
+	bool MeasureInChild(Options const& options, int size, double density, uint64_t seed, bool clustered, int generations,
+	                    int boards, Result* result)
+	{
+		int fds[2];
+		if (pipe(fds) != 0)
+		{
+			return false;
+		}
+
+		pid_t const pid = fork();
+		if (pid < 0)
+		{
+			close(fds[0]);
+			close(fds[1]);
+			return false;
+		}
+
+		if (pid == 0)
+		{
+			close(fds[0]);
+
+			Result child = {};
+			try
+			{
+				if (boards > 0)
+				{
+					child = MeasureEnsemble(options, size, density, seed, clustered, generations, boards);
+				}
+				else
+				{
+					child = Measure(options, RandomBoard(size, density, seed, clustered), generations);
+				}
+			}
+			catch (const char* msg)
+			{
+				std::cerr << msg << std::endl;
+				_exit(1);
+			}
+
+			struct rusage usage;
+			getrusage(RUSAGE_SELF, &usage);
+			child.peak_rss_kb = usage.ru_maxrss;
+
+			bool const ok = write(fds[1], &child, sizeof(child)) == static_cast<ssize_t>(sizeof(child));
+			_exit(ok ? 0 : 1);
+		}
+
+		close(fds[1]);
+		bool const ok = read(fds[0], result, sizeof(*result)) == static_cast<ssize_t>(sizeof(*result));
+		close(fds[0]);
+
+		int status = 0;
+		waitpid(pid, &status, 0);
+
+		return ok && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+	}
+}
+
+/******************************************************************************/
+/*!
+Parses the options, runs every configuration and prints the results
+
+\param argc
+Number of arguments
+
+\param argv
+Options described at the top of the file
+
+\return
+0 on success
+*/
+/******************************************************************************/
+int main(int argc, char** argv)
+{
+	std::vector<std::string> sizes = Split("64,256,1024");
+	std::vector<std::string> densities = Split("0.1,0.35");
+	std::vector<std::string> layouts = Split("uniform");
+	std::vector<std::string> threads;
+	std::vector<std::string> engines = Split("tiled,tiled-double,bitpacked,simd,hashlife,active,active-stealing,sparse,lookup");
+	int generations = 100;
+	int boards = 1000;
+	uint64_t seed = 1;
+	bool json = false;
+	bool numa = false;
+	Rule rule = kLife;
+
+	int const cores = static_cast<int>(std::thread::hardware_concurrency());
+	threads.push_back("1");
+	if (cores > 1)
+	{
+		threads.push_back(std::to_string(cores));
+	}
+
+	for (int i = 1; i < argc; ++i)
+	{
+		char const* arg = argv[i];
+		if (std::strncmp(arg, "--sizes=", 8) == 0)             { sizes = Split(arg + 8); }
+		else if (std::strncmp(arg, "--densities=", 12) == 0)   { densities = Split(arg + 12); }
+		else if (std::strncmp(arg, "--layouts=", 10) == 0)     { layouts = Split(arg + 10); }
+		else if (std::strncmp(arg, "--threads=", 10) == 0)     { threads = Split(arg + 10); }
+		else if (std::strncmp(arg, "--engines=", 10) == 0)     { engines = Split(arg + 10); }
+		else if (std::strncmp(arg, "--generations=", 14) == 0) { generations = std::atoi(arg + 14); }
+		else if (std::strncmp(arg, "--seed=", 7) == 0)        { seed = std::strtoull(arg + 7, 0, 10); }
+		else if (std::strncmp(arg, "--boards=", 9) == 0)      { boards = std::atoi(arg + 9); }
+		else if (std::strncmp(arg, "--rule=", 7) == 0)
+		{
+			try
+			{
+				rule = ParseRule(arg + 7);
+			}
+			catch (const char* msg)
+			{
+				std::cerr << msg << std::endl;
+				return 1;
+			}
+		}
+		else if (std::strcmp(arg, "--numa") == 0)             { numa = true; }
+		else if (std::strcmp(arg, "--json") == 0)             { json = true; }
+		else
+		{
+			std::cerr << "unknown option " << arg << std::endl;
+			return 1;
+		}
+	}
+
+	for (unsigned l = 0; l < layouts.size(); ++l)
+	{
+		if (layouts[l] != "uniform" && layouts[l] != "clustered")
+		{
+			std::cerr << "unknown layout " << layouts[l] << std::endl;
+			return 1;
+		}
+	}
+
+	if (json)
+	{
+		std::printf("[");
+	}
+	else
+	{
+		std::printf("engine,threads,width,height,density,layout,generations,seconds,cells_per_second,boards_per_second,p50_us,p90_us,p99_us,"
+		            "max_us,peak_rss_kb%s\n",
+		            numa ? ",local_pages,remote_pages" : "");
+	}
+
+	bool first = true;
+	for (unsigned e = 0; e < engines.size(); ++e)
+	{
+		EngineName const* engine = 0;
+		for (unsigned k = 0; k < sizeof(kEngines) / sizeof(kEngines[0]); ++k)
+		{
+			if (engines[e] == kEngines[k].name)
+			{
+				engine = &kEngines[k];
+			}
+		}
+
+		if (!engine)
+		{
+			std::cerr << "unknown engine " << engines[e] << std::endl;
+			return 1;
+		}
+
+		for (unsigned s = 0; s < sizes.size(); ++s)
+		{
+			for (unsigned d = 0; d < densities.size(); ++d)
+			{
+				for (unsigned l = 0; l < layouts.size(); ++l)
+				{
+					for (unsigned t = 0; t < threads.size(); ++t)
+					{
+						int const size = std::atoi(sizes[s].c_str());
+						double const density = std::atof(densities[d].c_str());
+						bool const clustered = layouts[l] == "clustered";
+
+						Options options;
+						options.engine = engine->engine;
+						options.num_threads = std::atoi(threads[t].c_str());
+						options.num_shards = options.num_threads;
+						options.rule = rule;
+						options.buffering = engine->buffering;
+						options.scheduling = engine->scheduling;
+						options.numa = numa;
+
+						Result result;
+						if (!MeasureInChild(options, size, density, seed, clustered, generations, engine->ensemble ? boards : 0,
+						                    &result))
+						{
+							std::cerr << "run failed: " << engine->name << " " << size << " " << threads[t] << std::endl;
+							continue;
+						}
+
+						bool const ensemble = engine->ensemble;
+						std::string const boards_per_second = Field("%.6g", result.boards_per_second, ensemble, json);
+						std::string const p50 = Field("%.3f", result.p50_us, !ensemble, json);
+						std::string const p90 = Field("%.3f", result.p90_us, !ensemble, json);
+						std::string const p99 = Field("%.3f", result.p99_us, !ensemble, json);
+						std::string const max = Field("%.3f", result.max_us, !ensemble, json);
+
+						if (json)
+						{
+							std::printf("%s\n  {\"engine\": \"%s\", \"threads\": %d, \"width\": %d, \"height\": %d, \"density\": %g, "
+							            "\"layout\": \"%s\", \"generations\": %d, \"seconds\": %.6f, \"cells_per_second\": %.6g, \"boards_per_second\": %s, "
+							            "\"p50_us\": %s, \"p90_us\": %s, \"p99_us\": %s, \"max_us\": %s, \"peak_rss_kb\": %ld",
+							            first ? "" : ",", engine->name, options.num_threads, size, size, density, layouts[l].c_str(), generations,
+							            result.seconds, result.cells_per_second, boards_per_second.c_str(), p50.c_str(), p90.c_str(),
+							            p99.c_str(), max.c_str(), result.peak_rss_kb);
+							if (numa)
+							{
+								std::printf(", \"local_pages\": %lld, \"remote_pages\": %lld", result.local_pages, result.remote_pages);
+							}
+							std::printf("}");
+						}
+						else
+						{
+							std::printf("%s,%d,%d,%d,%g,%s,%d,%.6f,%.6g,%s,%s,%s,%s,%s,%ld",
+							            engine->name, options.num_threads, size, size, density, layouts[l].c_str(), generations,
+							            result.seconds, result.cells_per_second, boards_per_second.c_str(), p50.c_str(), p90.c_str(),
+							            p99.c_str(), max.c_str(), result.peak_rss_kb);
+							if (numa)
+							{
+								std::printf(",%lld,%lld", result.local_pages, result.remote_pages);
+							}
+							std::printf("\n");
+						}
+						std::fflush(stdout);
+						first = false;
+					}
+				}
+			}
+		}
+	}
+
+	if (json)
+	{
+		std::printf("\n]\n");
+	}
+
+	return 0;
+}
@@ -0,0 +1,479 @@
+/******************************************************************************/
+/*!
+\file   bitboard.cpp
+\author Isaac Hill
+\par    email: Isaac.Hill@digipen.edu
+\par    DigiPen login: Isaac.Hill
+\par    Course: CS355
+\par    Assignment #1
+\date   1/21/2020
+\brief
+This is the Implementation file for the bit packed game of life engine
+*/
+/******************************************************************************/
+
+#include "bitboard.h"
+#include "simulation.h"
+#include "pool.h"
+#include "numa.h"
+#include "result.h"
+
+#include <algorithm>
+
+/******************************************************************************/
+/*!
+Creates an empty bit packed board
+
+\param width
+Cells in a row
+
+\param height
+Number of rows
+
+\return
+Created board to use
+*/
+/******************************************************************************/
+BitBoard CreateBitBoard(int width, int height)
+{
+	BitBoard result;
+	result.width = width;
+	result.height = height;
+	result.words = (width + 63) / 64;
+	result.stride = result.words + 2;
+	result.cells.assign(result.stride * (height + 2), 0);
+
+	return result;
+}
+
+/******************************************************************************/
+/*!
+Creates a bit packed board from the initial board
+
+\param initial
+Board to start from
+
+\return
+Created board to use
+*/
+/******************************************************************************/
+BitBoard CreateBitBoard(BoardView const& initial)
+{
+	BitBoard result = CreateBitBoard(initial.Width(), initial.Height());
+
+	initial.ForEachLive([&result](int x, int y)
+	{
+		result.Row(y)[x / 64] |= uint64_t(1) << (x % 64);
+	});
+
+	return result;
+}
+
+namespace
+{
+	/******************************************************************************/
+	/*!
+	Row stepping loop compiled once per rule, see DispatchRule
+	*/
+	/******************************************************************************/
+	template <uint32_t kBits>
+	struct RowKernel
+	{
+		static void Run(uint32_t rule, BitBoard const& from, BitBoard* to, int y0, int y1)
+		{
+			int const words = from.words;
+			if (words == 0)
+			{
+				return;
+			}
+
+			//Cells past the right edge must stay dead
+			uint64_t const tail_mask = from.TailMask();
+
+			for (int y = y0; y < y1; ++y)
+			{
+				uint64_t const* up = from.Row(y - 1);
+				uint64_t const* mid = from.Row(y);
+				uint64_t const* down = from.Row(y + 1);
+				uint64_t* out = to->Row(y);
+
+				for (int w = 0; w < words; ++w)
+				{
+					//West neighbor of bit i is bit i - 1, carried in from the word before
+					uint64_t const up_w = (up[w] << 1) | (up[w - 1] >> 63);
+					uint64_t const up_e = (up[w] >> 1) | (up[w + 1] << 63);
+					uint64_t const mid_w = (mid[w] << 1) | (mid[w - 1] >> 63);
+					uint64_t const mid_e = (mid[w] >> 1) | (mid[w + 1] << 63);
+					uint64_t const down_w = (down[w] << 1) | (down[w - 1] >> 63);
+					uint64_t const down_e = (down[w] >> 1) | (down[w + 1] << 63);
+
+					out[w] = StepWordRule<kBits>(rule, up_w, up[w], up_e, mid_w, mid[w], mid_e, down_w, down[w], down_e);
+				}
+
+				out[words - 1] &= tail_mask;
+			}
+		}
+	};
+}
+
+/******************************************************************************/
+/*!
+Steps a band of rows from one board into another
+
+\param from
+Board in the current generation
+
+\param to
+Board that receives the next generation, same size as from
+
+\param y0
+First row to step
+
+\param y1
+One past the last row to step
+
+\param rule
+Rule to step with
+*/
+/******************************************************************************/
+void StepRows(BitBoard const& from, BitBoard* to, int y0, int y1, Rule const& rule)
+{
+	DispatchRule<RowKernel>(RuleBits(rule), from, to, y0, y1);
+}
+
+/******************************************************************************/
+/*!
+Copies the first and last cell of some rows into the border on the other
+side, bit 63 of the word before the row and the bit just past the last cell
+
+\param board
+Board that was just written
+
+\param y0, y1
+First row and one past the last row to wrap, can include the border rows
+*/
+/******************************************************************************/
+void WrapColumns(BitBoard* board, int y0, int y1)
+{
+	if (board->width < 1)
+	{
+		return;
+	}
+
+	int const last = board->width - 1;
+	int const past = board->width;
+	uint64_t const past_bit = uint64_t(1) << (past % 64);
+
+	for (int y = y0; y < y1; ++y)
+	{
+		uint64_t* row = board->Row(y);
+		uint64_t const first_cell = row[0] & 1;
+		uint64_t const last_cell = (row[last / 64] >> (last % 64)) & 1;
+
+		row[-1] = last_cell << 63;
+		row[past / 64] = (row[past / 64] & ~past_bit) | (first_cell << (past % 64));
+	}
+}
+
+/******************************************************************************/
+/*!
+Wraps the border around the rows a worker just wrote, so the next step sees
+a torus without any wrapping in the kernel. The rows above and below the
+board go with the worker that owns the last and first row.
+
+\param board
+Board that was just written
+
+\param y0, y1
+First row and one past the last row that were written
+*/
+/******************************************************************************/
+void WrapBorder(BitBoard* board, int y0, int y1)
+{
+	if (board->width < 1 || board->height < 1)
+	{
+		return;
+	}
+
+	//Columns first, so the copied rows carry their corner cells
+	WrapColumns(board, y0, y1);
+
+	if (y0 == 0)
+	{
+		std::copy(board->Row(0) - 1, board->Row(0) - 1 + board->stride, board->Row(board->height) - 1);
+	}
+	if (y1 == board->height)
+	{
+		std::copy(board->Row(board->height - 1) - 1, board->Row(board->height - 1) - 1 + board->stride, board->Row(-1) - 1);
+	}
+}
+
+/******************************************************************************/
+/*!
+Gets coordinates of all live spaces on board, in the same order as the
+nested vector version
+
+\param board
+The board in the final state
+
+\return
+All coordinates of live spaces on board
+*/
+/******************************************************************************/
+std::vector< std::tuple<int, int> > GetResult(BitBoard const& board)
+{
+	std::vector< std::tuple<int, int> > result;
+
+	for (int x = 0; x < board.width; ++x)
+	{
+		uint64_t const bit = uint64_t(1) << (x % 64);
+		for (int y = 0; y < board.height; ++y)
+		{
+			if (board.Row(y)[x / 64] & bit)
+			{
+				result.push_back(std::make_tuple(x, y));
+			}
+		}
+	}
+
+	return result;
+}
+
+/******************************************************************************/
+/*!
+Visits every live cell row by row, a whole word of dead cells at a time. The
+last word is masked, it can hold a wrapped border cell.
+
+\param board
+Board to scan
+
+\param visit
+Called with the coordinates of each live cell
+*/
+/******************************************************************************/
+void ForEachLive(BitBoard const& board, std::function<void(int, int)> const& visit)
+{
+	for (int y = 0; y < board.height; ++y)
+	{
+		uint64_t const* row = board.Row(y);
+		for (int w = 0; w < board.words; ++w)
+		{
+			uint64_t word = w + 1 < board.words ? row[w] : row[w] & board.TailMask();
+			while (word)
+			{
+				visit(w * 64 + __builtin_ctzll(word), y);
+				word &= word - 1;
+			}
+		}
+	}
+}
+
+/******************************************************************************/
+/*!
+Hashes every word of the board, without any wrapped border cell
+
+\param board
+Board to hash
+
+\return
+Hash of the cells
+*/
+/******************************************************************************/
+uint64_t HashBoard(BitBoard const& board)
+{
+	uint64_t hash = 0;
+	for (int y = 0; y < board.height; ++y)
+	{
+		uint64_t const* row = board.Row(y);
+		for (int w = 0; w < board.words; ++w)
+		{
+			hash = HashWord(hash, w + 1 < board.words ? row[w] : row[w] & board.TailMask());
+		}
+	}
+
+	return hash;
+}
+
+namespace
+{
+	/******************************************************************************/
+	/*!
+	Two bit packed boards that are swapped every generation, each worker owns
+	a band of rows and steps it with the row kernel the engine was made with
+	*/
+	/******************************************************************************/
+	class BitSimulation : public Simulation
+	{
+	public:
+		BitSimulation(BoardView const& initial, Options const& options, BitRowKernel const& kernel);
+
+		void Advance(int generations);
+		std::vector< std::tuple<int, int> > Result() const;
+		uint64_t Hash() const { return HashBoard(boards_[current_]); }
+		bool Alive(int x, int y) const { return (boards_[current_].Row(y)[x / 64] >> (x % 64)) & 1; }
+		void ForEachLive(std::function<void(int, int)> const& visit) const { ::ForEachLive(boards_[current_], visit); }
+		void GetStats(Stats* stats) const { CountBandPages(boards_, bands_, pool_, stats); }
+		bool GetBitmap(Bitmap* view) const { *view = Bitmap(Width(), Height(), boards_[current_].Row(0), boards_[current_].stride); return true; }
+
+	private:
+		void Step(int worker, int generations);
+
+		BitBoard boards_[2];
+		int current_;
+		BitRowKernel kernel_;
+		Boundary boundary_;
+		std::vector<Tile> bands_;
+		WorkerPool pool_;
+		Barrier barrier_;
+	};
+
+	/******************************************************************************/
+	/*!
+	Creates both boards and splits the rows into one band per worker
+
+	\param initial
+	Board to start from
+
+	\param options
+	Thread count and boundary to use
+
+	\param kernel
+	Steps a band of rows under the rule of the run
+	*/
+	/******************************************************************************/
+	BitSimulation::BitSimulation(BoardView const& initial, Options const& options, BitRowKernel const& kernel)
+		: Simulation(initial.Width(), initial.Height()),
+		  current_(0),
+		  kernel_(kernel),
+		  boundary_(options.boundary),
+		  bands_(SplitBands(initial.Width(), initial.Height(), options.num_threads > 0 ? options.num_threads : WorkerPool::DefaultSize())),
+		  pool_(static_cast<int>(bands_.size()), options.numa),
+		  barrier_(static_cast<int>(bands_.size()), options.barrier)
+	{
+		boards_[0] = CreateBitBoard(initial);
+		boards_[1] = CreateBitBoard(initial.Width(), initial.Height());
+		if (boundary_ == Boundary::kWrap)
+		{
+			WrapBorder(&boards_[0], 0, initial.Height());
+		}
+		if (options.numa && !bands_.empty())
+		{
+			PlaceBands(boards_, initial.Height(), bands_, &pool_);
+		}
+		tracer_.Start(pool_.Size());
+	}
+
+	/******************************************************************************/
+	/*!
+	Steps the board on every worker
+
+	\param generations
+	Number of generations to step
+	*/
+	/******************************************************************************/
+	void BitSimulation::Advance(int generations)
+	{
+		if (generations <= 0 || bands_.empty())
+		{
+			return;
+		}
+
+		pool_.Run([this, generations](int worker) { Step(worker, generations); });
+
+		current_ = (current_ + generations) % 2;
+	}
+
+	/******************************************************************************/
+	/*!
+	Main logic for one worker, only one barrier per generation is needed since
+	nobody writes the board that is being read
+
+	\param worker
+	Index of the worker and of the band it owns
+
+	\param generations
+	Number of generations to step
+	*/
+	/******************************************************************************/
+	void BitSimulation::Step(int worker, int generations)
+	{
+		Tile const band = bands_[worker];
+		int current = current_;
+
+		for (int i = 0; i < generations; ++i)
+		{
+			{
+				GOL_TRACE_PHASE(&tracer_, worker, Phase::kCompute, i);
+				kernel_(boards_[current], &boards_[1 - current], band.y0, band.y1);
+				if (boundary_ == Boundary::kWrap)
+				{
+					WrapBorder(&boards_[1 - current], band.y0, band.y1);
+				}
+			}
+			current = 1 - current;
+
+			{
+				GOL_TRACE_PHASE(&tracer_, worker, Phase::kBarrier, i);
+				barrier_.Wait(worker);
+			}
+		}
+	}
+
+	/******************************************************************************/
+	/*!
+	Gets coordinates of all live spaces on board
+
+	\return
+	All coordinates of live spaces on board
+	*/
+	/******************************************************************************/
+	std::vector< std::tuple<int, int> > BitSimulation::Result() const
+	{
+		return GetResult(boards_[current_]);
+	}
+}
+
+/******************************************************************************/
+/*!
+Creates the bit packed engine
+
+\param initial
+Board to start from
+
+\param options
+Thread count to use
+
+\return
+Newly allocated simulation, owned by the caller
+*/
+/******************************************************************************/
+Simulation* CreateBitSimulation(BoardView const& initial, Options const& options)
+{
+	Rule const rule = options.rule;
+	return CreateBitSimulation(initial, options, [rule](BitBoard const& from, BitBoard* to, int y0, int y1)
+	{
+		StepRows(from, to, y0, y1, rule);
+	});
+}
+
+/******************************************************************************/
+/*!
+Creates the banded bit packed engine with another way of stepping the rows
+
+\param initial
+Board to start from
+
+\param options
+Thread count and boundary to use
+
+\param kernel
+Steps a band of rows, it must follow options.rule
+
+\return
+Newly allocated simulation, owned by the caller
+*/
+/******************************************************************************/
+Simulation* CreateBitSimulation(BoardView const& initial, Options const& options, BitRowKernel const& kernel)
+{
+	return new BitSimulation(initial, options, kernel);
+}
@@ -0,0 +1,244 @@
+/******************************************************************************/
+/*!
+\file   bitboard.h
+\author Isaac Hill
+\par    email: Isaac.Hill@digipen.edu
+\par    DigiPen login: Isaac.Hill
+\par    Course: CS355
+\par    Assignment #1
+\date   1/21/2020
+\brief
+This is the Header file for the bit packed game of life board, 64 cells are
+stored per word and stepped together with bitwise adders
+*/
+/******************************************************************************/
+
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include "gol.h"
+#include "rule.h"
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include <tuple>
+
+class Simulation;
+
+/******************************************************************************/
+/*!
+Bit x % 64 of word x / 64 holds cell x of a row. Every row has a zero word
+on both ends and there is a zero row above and below the board, so the
+kernel never has to check for the edge. On a torus that border holds copies
+of the cells on the other side instead: bit 63 of the word before the row,
+the bit just past the last cell and the rows above and below.
+*/
+/******************************************************************************/
+struct BitBoard
+{
+	int width;
+	int height;
+	int words;  // words holding cells in one row
+	int stride; // words + 2 padding words
+	std::vector<uint64_t> cells;
+
+	uint64_t* Row(int y) { return &cells[(y + 1) * stride + 1]; }
+	uint64_t const* Row(int y) const { return &cells[(y + 1) * stride + 1]; }
+
+	// Start of row y with its padding, -1 and height are the border rows and
+	// height + 1 is the end of the board
+	uint64_t* Line(int y) { return cells.data() + (y + 1) * stride; }
+	uint64_t const* Line(int y) const { return cells.data() + (y + 1) * stride; }
+
+	// Bits of the last word of a row that hold cells
+	uint64_t TailMask() const { return (width % 64) ? (uint64_t(1) << (width % 64)) - 1 : ~uint64_t(0); }
+};
+
+/******************************************************************************/
+/*!
+Next state of 64 cells at once
+
+\param up_w, up, up_e
+Row above shifted so each bit lines up with its west, own and east neighbor
+
+\param mid_w, mid, mid_e
+Own row, mid holds the cells being stepped
+
+\param down_w, down, down_e
+Row below
+
+\return
+Bit set for every cell alive in the next generation
+*/
+/******************************************************************************/
+inline uint64_t StepWord(uint64_t up_w, uint64_t up, uint64_t up_e,
+                         uint64_t mid_w, uint64_t mid, uint64_t mid_e,
+                         uint64_t down_w, uint64_t down, uint64_t down_e)
+{
+	//Full adder on the row above, ones in a0 and twos in a1
+	uint64_t t = up_w ^ up;
+	uint64_t const a0 = t ^ up_e;
+	uint64_t const a1 = (up_w & up) | (t & up_e);
+
+	//Full adder on the row below
+	t = down_w ^ down;
+	uint64_t const b0 = t ^ down_e;
+	uint64_t const b1 = (down_w & down) | (t & down_e);
+
+	//Half adder on the two side neighbors
+	uint64_t const c0 = mid_w ^ mid_e;
+	uint64_t const c1 = mid_w & mid_e;
+
+	//Add up the ones
+	t = a0 ^ b0;
+	uint64_t const s0 = t ^ c0;
+	uint64_t const d1 = (a0 & b0) | (t & c0);
+
+	//Count is 2 or 3 only when exactly one of the twos is set
+	t = a1 ^ b1;
+	uint64_t const e0 = t ^ c1;
+	uint64_t const e1 = (a1 & b1) | (t & c1);
+	uint64_t const one_two = ~e1 & (e0 ^ d1);
+
+	//Born on 3, survives on 2 or 3
+	return one_two & (s0 | mid);
+}
+
+/******************************************************************************/
+/*!
+Cells whose neighbor count is n, from the four bits of the count
+
+\param n
+Count to look for, a constant once inlined
+
+\param s0, e0, e1, e2
+Bits worth 1, 2, 4 and 8 of every cell's count
+
+\return
+Bit set for every cell with n live neighbors
+*/
+/******************************************************************************/
+inline uint64_t CountIs(int n, uint64_t s0, uint64_t e0, uint64_t e1, uint64_t e2)
+{
+	return (n & 1 ? s0 : ~s0) & (n & 2 ? e0 : ~e0) & (n & 4 ? e1 : ~e1) & (n & 8 ? e2 : ~e2);
+}
+
+/******************************************************************************/
+/*!
+Cells with count n that are alive next generation under the rule, without a
+branch. When the rule is a constant the masks are too and terms for counts
+the rule does not use fold away.
+
+\param rule
+Rule bits
+
+\param n
+Neighbor count
+
+\param count_is
+Cells with n live neighbors
+
+\param mid
+Cells alive now
+
+\return
+Bit set for every such cell alive next generation
+*/
+/******************************************************************************/
+inline uint64_t RuleTerm(uint32_t rule, int n, uint64_t count_is, uint64_t mid)
+{
+	uint64_t const born = 0 - static_cast<uint64_t>((rule >> n) & 1);
+	uint64_t const stays = 0 - static_cast<uint64_t>((rule >> (n + 9)) & 1);
+	return count_is & ((born & ~mid) | (stays & mid));
+}
+
+/******************************************************************************/
+/*!
+Next state of 64 cells at once under any rule. The neighbors are added up
+into a four bit count per cell, then every count the rule names is matched.
+Life keeps the shorter StepWord through the specialization below.
+
+\param rule
+Rule bits, only read by the kAnyRule instance
+
+\param up_w, up, up_e
+Row above shifted so each bit lines up with its west, own and east neighbor
+
+\param mid_w, mid, mid_e
+Own row, mid holds the cells being stepped
+
+\param down_w, down, down_e
+Row below
+
+\return
+Bit set for every cell alive in the next generation
+*/
+/******************************************************************************/
+template <uint32_t kBits>
+inline uint64_t StepWordRule(uint32_t rule,
+                             uint64_t up_w, uint64_t up, uint64_t up_e,
+                             uint64_t mid_w, uint64_t mid, uint64_t mid_e,
+                             uint64_t down_w, uint64_t down, uint64_t down_e)
+{
+	uint32_t const bits = SelectRule<kBits>(rule);
+
+	//Same adders as StepWord, ones in a0 b0 c0 and twos in a1 b1 c1
+	uint64_t t = up_w ^ up;
+	uint64_t const a0 = t ^ up_e;
+	uint64_t const a1 = (up_w & up) | (t & up_e);
+
+	t = down_w ^ down;
+	uint64_t const b0 = t ^ down_e;
+	uint64_t const b1 = (down_w & down) | (t & down_e);
+
+	uint64_t const c0 = mid_w ^ mid_e;
+	uint64_t const c1 = mid_w & mid_e;
+
+	t = a0 ^ b0;
+	uint64_t const s0 = t ^ c0;
+	uint64_t const d1 = (a0 & b0) | (t & c0);
+
+	//Four twos make a count of 0 to 8, e0 e1 e2 are worth 2, 4 and 8
+	uint64_t const p = a1 ^ b1;
+	uint64_t const q = c1 ^ d1;
+	uint64_t const e0 = p ^ q;
+	uint64_t const e1 = (a1 & b1) ^ (c1 & d1) ^ (p & q);
+	uint64_t const e2 = a1 & b1 & c1 & d1;
+
+	return RuleTerm(bits, 0, CountIs(0, s0, e0, e1, e2), mid) |
+	       RuleTerm(bits, 1, CountIs(1, s0, e0, e1, e2), mid) |
+	       RuleTerm(bits, 2, CountIs(2, s0, e0, e1, e2), mid) |
+	       RuleTerm(bits, 3, CountIs(3, s0, e0, e1, e2), mid) |
+	       RuleTerm(bits, 4, CountIs(4, s0, e0, e1, e2), mid) |
+	       RuleTerm(bits, 5, CountIs(5, s0, e0, e1, e2), mid) |
+	       RuleTerm(bits, 6, CountIs(6, s0, e0, e1, e2), mid) |
+	       RuleTerm(bits, 7, CountIs(7, s0, e0, e1, e2), mid) |
+	       RuleTerm(bits, 8, CountIs(8, s0, e0, e1, e2), mid);
+}
+
+template <>
+inline uint64_t StepWordRule<kLifeBits>(uint32_t,
+                                        uint64_t up_w, uint64_t up, uint64_t up_e,
+                                        uint64_t mid_w, uint64_t mid, uint64_t mid_e,
+                                        uint64_t down_w, uint64_t down, uint64_t down_e)
+{
+	return StepWord(up_w, up, up_e, mid_w, mid, mid_e, down_w, down, down_e);
+}
+
+// Steps rows [y0, y1) of one board into another, whatever the rule and method
+typedef std::function<void(BitBoard const& from, BitBoard* to, int y0, int y1)> BitRowKernel;
+
+BitBoard CreateBitBoard(int width, int height);
+BitBoard CreateBitBoard(BoardView const& initial);
+void StepRows(BitBoard const& from, BitBoard* to, int y0, int y1, Rule const& rule);
+void WrapColumns(BitBoard* board, int y0, int y1);
+void WrapBorder(BitBoard* board, int y0, int y1);
+std::vector< std::tuple<int, int> > GetResult(BitBoard const& board);
+void ForEachLive(BitBoard const& board, std::function<void(int, int)> const& visit);
+uint64_t HashBoard(BitBoard const& board);
+
+// The banded bit packed engine stepping its rows with any kernel
+Simulation* CreateBitSimulation(BoardView const& initial, Options const& options, BitRowKernel const& kernel);
+
+#endif
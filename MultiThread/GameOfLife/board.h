@@ -0,0 +1,40 @@
+/******************************************************************************/
+/*!
+\file   board.h
+\author Isaac Hill
+\par    email: Isaac.Hill@digipen.edu
+\par    DigiPen login: Isaac.Hill
+\par    Course: CS355
+\par    Assignment #1
+\date   1/21/2020
+\brief
+This is the Header file for the board helpers shared by the game of life
+engines
+*/
+/******************************************************************************/
+
+#ifndef BOARD_H
+#define BOARD_H
+
+#include "gol.h"
+
+#include <vector>
+#include <tuple>
+
+enum State
+{
+	kDead,
+	kAlive
+};
+
+// Board is indexed [x][y] and has a 1 space dead border on every side
+typedef std::vector<std::vector<State>> Board;
+
+Board CreateBoard(std::vector< std::tuple<int, int> > initial_population, int max_x, int max_y);
+Board CreateBoard(BoardView const& initial);
+void WrapBorder(Board* board, int x0, int x1, int y0, int y1);
+State CalculateNewState(Board *board, int x_pos, int y_pos);
+State CalculateNewState(Board *board, int x_pos, int y_pos, Rule const& rule);
+std::vector< std::tuple<int, int> > GetResult(Board const& board);
+
+#endif
@@ -0,0 +1,244 @@
+/******************************************************************************/
+/*!
+\file   checkpoint.cpp
+\author Isaac Hill
+\par    email: Isaac.Hill@digipen.edu
+\par    DigiPen login: Isaac.Hill
+\par    Course: CS355
+\par    Assignment #1
+\date   1/21/2020
+\brief
+This is the Implementation file for writing snapshots in the background and
+reading them back to resume a run
+*/
+/******************************************************************************/
+
+#include "checkpoint.h"
+#include "rule.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+namespace
+{
+	char const kGeneration[] = "generation ";
+	char const kRule[] = "rule ";
+	char const kBoundary[] = "boundary ";
+
+	/******************************************************************************/
+	/*!
+	Name a boundary is written with
+
+	\param boundary
+	Boundary to name
+
+	\return
+	"dead" or "wrap"
+	*/
+	/******************************************************************************/
+	char const* BoundaryName(Boundary boundary)
+	{
+		return boundary == Boundary::kWrap ? "wrap" : "dead";
+	}
+}
+
+/******************************************************************************/
+/*!
+Starts the writer thread
+
+\param path
+File every snapshot is written to
+
+\param rule
+Rule the run follows, recorded in every snapshot
+
+\param boundary
+Boundary the run uses, recorded in every snapshot
+*/
+/******************************************************************************/
+CheckpointWriter::CheckpointWriter(char const* path, Rule const& rule, Boundary boundary)
+	: path_(path), rule_(FormatRule(rule)), boundary_(boundary), pending_generation_(0), quit_(false), failed_(false)
+{
+	thread_ = std::thread([this]() { Work(); });
+}
+
+/******************************************************************************/
+/*!
+Writes the last snapshot if it is still waiting and stops the thread
+*/
+/******************************************************************************/
+CheckpointWriter::~CheckpointWriter()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		quit_ = true;
+	}
+	wake_.notify_one();
+
+	if (thread_.joinable())
+	{
+		thread_.join();
+	}
+}
+
+/******************************************************************************/
+/*!
+Copies the live cells of the board for the writer thread, any snapshot
+still waiting is dropped for this newer one
+
+\param board
+Board to save, only read during the call
+
+\param generation
+Generation of the board counted from the start of the run
+*/
+/******************************************************************************/
+void CheckpointWriter::Save(BoardView const& board, long long generation)
+{
+	std::unique_ptr<CellList> copy(new CellList(board.Width(), board.Height()));
+	CellList* cells = copy.get();
+	board.ForEachLive([cells](int x, int y) { cells->Set(x, y); });
+
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		pending_ = std::move(copy);
+		pending_generation_ = generation;
+	}
+	wake_.notify_one();
+}
+
+/******************************************************************************/
+/*!
+Waits for the writer thread to write what is waiting and stop
+
+\exception const char*
+If any snapshot could not be written
+*/
+/******************************************************************************/
+void CheckpointWriter::Finish()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		quit_ = true;
+	}
+	wake_.notify_one();
+
+	if (thread_.joinable())
+	{
+		thread_.join();
+	}
+
+	if (failed_)
+	{
+		throw "cannot write checkpoint file";
+	}
+}
+
+/******************************************************************************/
+/*!
+Main logic of the writer thread, writes snapshots as they come until told
+to quit with nothing waiting
+*/
+/******************************************************************************/
+void CheckpointWriter::Work()
+{
+	std::string const temporary = path_ + ".tmp";
+
+	for (;;)
+	{
+		std::unique_ptr<CellList> board;
+		long long generation;
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			wake_.wait(lock, [this]() { return pending_ || quit_; });
+
+			if (!pending_)
+			{
+				return;
+			}
+
+			board = std::move(pending_);
+			generation = pending_generation_;
+		}
+
+		//Engines visit their cells in their own order, the RLE body is row major
+		board->Sort();
+
+		std::vector<std::string> comments;
+		comments.push_back(kGeneration + std::to_string(generation));
+		comments.push_back(kRule + rule_);
+		comments.push_back(kBoundary + std::string(BoundaryName(boundary_)));
+
+		try
+		{
+			SaveRle(*board, temporary.c_str(), comments);
+			if (std::rename(temporary.c_str(), path_.c_str()) != 0)
+			{
+				throw "cannot rename checkpoint file";
+			}
+		}
+		catch (const char*)
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			failed_ = true;
+		}
+	}
+}
+
+/******************************************************************************/
+/*!
+Loads a snapshot written by CheckpointWriter
+
+\param path
+Snapshot to load
+
+\param rule
+Rule the resumed run follows
+
+\param boundary
+Boundary the resumed run uses
+
+\param generation
+Receives the generation the snapshot was taken at
+
+\return
+The board at that generation
+*/
+/******************************************************************************/
+CellList LoadCheckpoint(char const* path, Rule const& rule, Boundary boundary, long long* generation)
+{
+	std::vector<std::string> comments;
+	CellList result = LoadRleCells(path, &comments);
+
+	bool seen_generation = false;
+	for (unsigned i = 0; i < comments.size(); ++i)
+	{
+		std::string const& comment = comments[i];
+		if (comment.compare(0, sizeof(kGeneration) - 1, kGeneration) == 0)
+		{
+			*generation = std::strtoll(comment.c_str() + sizeof(kGeneration) - 1, 0, 10);
+			seen_generation = true;
+		}
+		else if (comment.compare(0, sizeof(kRule) - 1, kRule) == 0)
+		{
+			if (comment.substr(sizeof(kRule) - 1) != FormatRule(rule))
+			{
+				throw "checkpoint was written with another rule";
+			}
+		}
+		else if (comment.compare(0, sizeof(kBoundary) - 1, kBoundary) == 0)
+		{
+			if (comment.substr(sizeof(kBoundary) - 1) != BoundaryName(boundary))
+			{
+				throw "checkpoint was written with another boundary";
+			}
+		}
+	}
+
+	if (!seen_generation || *generation < 0)
+	{
+		throw "not a checkpoint file";
+	}
+
+	return result;
+}
@@ -0,0 +1,74 @@
+/******************************************************************************/
+/*!
+\file   checkpoint.h
+\author Isaac Hill
+\par    email: Isaac.Hill@digipen.edu
+\par    DigiPen login: Isaac.Hill
+\par    Course: CS355
+\par    Assignment #1
+\date   1/21/2020
+\brief
+This is the Header file for the snapshots a long run leaves behind so it can
+be resumed. A snapshot is an RLE file whose #C lines record the generation,
+the rule and the boundary it was taken with.
+*/
+/******************************************************************************/
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include "gol.h"
+#include "pattern.h"
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+/******************************************************************************/
+/*!
+Writes snapshots of a running board on a thread of its own. Save only copies
+the live cells of the board, so a huge sparse board costs its population,
+and encoding and writing happen on the writer thread. If the writer is still busy when the next snapshot comes the
+one waiting is replaced by the newer one, so stepping never waits for the
+disk. Every snapshot goes to a temporary file that is renamed over the last
+one, so the file always holds a whole snapshot.
+*/
+/******************************************************************************/
+class CheckpointWriter
+{
+public:
+	CheckpointWriter(char const* path, Rule const& rule, Boundary boundary);
+	~CheckpointWriter();
+
+	// Copies the board, it is written in the background
+	void Save(BoardView const& board, long long generation);
+
+	// Waits for the last snapshot to be written, throws if any could not be
+	void Finish();
+
+private:
+	CheckpointWriter(CheckpointWriter const&);
+	CheckpointWriter& operator=(CheckpointWriter const&);
+
+	void Work();
+
+	std::string path_;
+	std::string rule_;
+	Boundary boundary_;
+
+	std::mutex mutex_;
+	std::condition_variable wake_;
+	std::unique_ptr<CellList> pending_; // next board to write, null when there is none
+	long long pending_generation_;
+	bool quit_;
+	bool failed_;
+	std::thread thread_;
+};
+
+// Loads a snapshot and the generation it was taken at, throws if it is not a
+// snapshot or was taken with another rule or boundary
+CellList LoadCheckpoint(char const* path, Rule const& rule, Boundary boundary, long long* generation);
+
+#endif
@@ -7,6 +7,10 @@
 /******************************************************************************/
 
 #include "gol.h"
+#include "pattern.h"
+#include "result.h"
+#include "async.h"
+#include <chrono>
 #include <fstream>   /* ifstream */
 #include <iostream>
 #include <iomanip>
@@ -14,7 +18,14 @@
 #include <algorithm>
 #include <tuple>
 #include <cstdio>    /* sscanf */
+#include <cstring>   /* strncmp */
 
+Options options; // engine picked with --engine= and --threads=
+char const * resume_file = 0; // snapshot picked with --resume=
+int ensemble_boards = 0; // copies of the board run together with --ensemble=, 0 runs it alone
+int async_cancel_after = -1; // ms before an async run picked with --async-cancel-after= is cancelled, -1 runs it in place
+
+// the original renderer, Render in result.h draws the same text from a bitmap without sorting
 void draw( std::vector< std::tuple<int,int> > & population, int max_x, int max_y )
 {
     std::sort( population.begin(), population.end(),
@@ -110,19 +121,115 @@ read( char const * infile )
     return std::make_tuple( initial_population, max_x, max_y );
 }
 
+// .rle files are mapped and loaded as a list of live cells, so a huge board costs only its population
+bool is_rle_file( char const * infile )
+{
+    size_t const length = std::strlen( infile );
+    return length > 4 && std::strcmp( infile + length - 4, ".rle" ) == 0;
+}
+
+// .golb files are mapped and loaded straight into a bit packed board
+bool is_bitmap_file( char const * infile )
+{
+    size_t const length = std::strlen( infile );
+    return length > 5 && std::strcmp( infile + length - 5, ".golb" ) == 0;
+}
+
+// any input file as a list of live cells, for the entry points that only take a list
+std::tuple< std::vector< std::tuple<int,int> >, int, int > // population, max_x, max_y
+read_population( char const * infile )
+{
+    if ( !is_rle_file( infile ) && !is_bitmap_file( infile ) ) {
+        return read( infile );
+    }
+
+    std::vector< std::tuple<int,int> > initial_population;
+    if ( is_rle_file( infile ) ) {
+        CellList const pattern = LoadRleCells( infile );
+        return std::make_tuple( pattern.Cells(), pattern.Width(), pattern.Height() );
+    }
+
+    Pattern const pattern = LoadBitmap( infile );
+    pattern.ForEachLive( [&initial_population]( int x, int y ) { initial_population.push_back( std::make_tuple( x,y ) ); } );
+    return std::make_tuple( initial_population, pattern.Width(), pattern.Height() );
+}
+
+// runs ensemble_boards copies of the board through run_ensemble, every copy must end the same
+void test_ensemble( char const * infile, int num_iter )
+{
+    std::vector< std::tuple<int,int> > initial_population;
+    int max_x, max_y;
+    std::tie( initial_population, max_x, max_y ) = read_population( infile );
+
+    std::vector< std::vector< std::tuple<int,int> > > const initial_populations( ensemble_boards, initial_population );
+    std::vector< std::vector< std::tuple<int,int> > > final_populations = run_ensemble( initial_populations, num_iter, max_x, max_y, options );
+    for ( unsigned i=1; i<final_populations.size(); ++i ) {
+        if ( final_populations[i] != final_populations[0] ) {
+            throw "ensemble boards differ";
+        }
+    }
+
+    draw( final_populations[0], max_x, max_y );
+}
+
+// runs the board through run_async and cancels it after async_cancel_after ms,
+// a cancelled run draws the board it stopped at and says so on stderr
+void test_async( char const * infile, int num_iter )
+{
+    std::vector< std::tuple<int,int> > initial_population;
+    int max_x, max_y;
+    std::tie( initial_population, max_x, max_y ) = read_population( infile );
+
+    RunHandle handle = run_async( initial_population, num_iter, max_x, max_y, options );
+    if ( handle.wait_for( std::chrono::milliseconds( async_cancel_after ) ) != std::future_status::ready ) {
+        handle.cancel();
+    }
+
+    std::vector< std::tuple<int,int> > final_population = handle.get();
+    if ( handle.generation() < num_iter ) {
+        std::cerr << "cancelled after " << handle.generation() << " generations" << std::endl;
+    }
+
+    draw( final_population, max_x, max_y );
+}
+
 void test( char const * infile, int num_iter )
 {
+    if ( ensemble_boards > 0 ) {
+        test_ensemble( infile, num_iter );
+        return;
+    }
+
+    if ( async_cancel_after >= 0 ) {
+        test_async( infile, num_iter );
+        return;
+    }
+
+    if ( is_rle_file( infile ) ) {
+        CellList const pattern = LoadRleCells( infile );
+        RunResult const final_board = run_bitmap( pattern, num_iter, options );
+        Render( final_board.View(), std::cout );
+        return;
+    }
+
+    if ( is_bitmap_file( infile ) ) {
+        Pattern const pattern = LoadBitmap( infile );
+        RunResult const final_board = run_bitmap( pattern, num_iter, options );
+        Render( final_board.View(), std::cout );
+        return;
+    }
+
     std::vector< std::tuple<int,int> > initial_population;
     int max_x, max_y;
     std::tie( initial_population, max_x, max_y ) = read( infile );
 
     //draw( initial_population, max_x, max_y );
  
-    std::vector< std::tuple<int,int> > final_population = run( initial_population, num_iter, max_x, max_y );
-    draw( final_population, max_x, max_y );
+    RunResult const final_board = run_bitmap( initial_population, num_iter, max_x, max_y, options );
+    Render( final_board.View(), std::cout );
     // print final_population
 #if 0
-    for ( auto const & t : final_population ) {
+    for ( auto const & t : final_board ) {
         int i,j;
         std::tie( i,j ) = t;
         std::cout << i << " " << j << std::endl;
@@ -147,8 +254,109 @@ void (*pTests[])() = {
     test0,test1,test2,test3,test4,test5,test6,test7
 }; 
 
+// strips the engine options (--engine=name, --threads=n, --shards=n, --double-buffered, --detect-cycles,
+// --temporal-block=k, --barrier=central|dissemination, --work-stealing, --rule=B3/S23, --wrap, --numa, --trace=file,
+// --checkpoint=file, --checkpoint-every=n, --checkpoint-seconds=t, --resume=file, --ensemble=n,
+// --async-cancel-after=ms) from the arguments
+bool parse_options( int & argc, char ** argv )
+{
+    int kept = 1;
+    for ( int i=1; i<argc; ++i ) {
+        if ( std::strncmp( argv[i], "--engine=", 9 ) == 0 ) {
+            char const * name = argv[i] + 9;
+            if      ( std::strcmp( name, "percell" ) == 0 ) { options.engine = Engine::kPerCell; }
+            else if ( std::strcmp( name, "tiled" ) == 0 )   { options.engine = Engine::kTiled; }
+            else if ( std::strcmp( name, "bitpacked" ) == 0 ) { options.engine = Engine::kBitPacked; }
+            else if ( std::strcmp( name, "simd" ) == 0 )    { options.engine = Engine::kSimd; }
+            else if ( std::strcmp( name, "hashlife" ) == 0 ) { options.engine = Engine::kHashLife; }
+            else if ( std::strcmp( name, "active" ) == 0 )  { options.engine = Engine::kActive; }
+            else if ( std::strcmp( name, "sparse" ) == 0 )  { options.engine = Engine::kSparse; }
+            else if ( std::strcmp( name, "sharded" ) == 0 ) { options.engine = Engine::kSharded; }
+            else if ( std::strcmp( name, "lookup" ) == 0 )  { options.engine = Engine::kLookup; }
+            else {
+                std::cout << "unknown engine " << name << std::endl;
+                return false;
+            }
+        } else if ( std::strncmp( argv[i], "--threads=", 10 ) == 0 ) {
+            std::sscanf( argv[i] + 10, "%i", &options.num_threads );
+        } else if ( std::strncmp( argv[i], "--shards=", 9 ) == 0 ) {
+            std::sscanf( argv[i] + 9, "%i", &options.num_shards );
+        } else if ( std::strcmp( argv[i], "--double-buffered" ) == 0 ) {
+            options.buffering = Buffering::kDoubleBuffered;
+        } else if ( std::strcmp( argv[i], "--detect-cycles" ) == 0 ) {
+            options.detect_cycles = true;
+        } else if ( std::strncmp( argv[i], "--temporal-block=", 17 ) == 0 ) {
+            std::sscanf( argv[i] + 17, "%i", &options.temporal_block );
+        } else if ( std::strcmp( argv[i], "--work-stealing" ) == 0 ) {
+            options.scheduling = Scheduling::kWorkStealing;
+        } else if ( std::strncmp( argv[i], "--rule=", 7 ) == 0 ) {
+            try {
+                options.rule = ParseRule( argv[i] + 7 );
+            } catch( const char* msg ) {
+                std::cout << msg << std::endl;
+                return false;
+            }
+        } else if ( std::strcmp( argv[i], "--wrap" ) == 0 ) {
+            options.boundary = Boundary::kWrap;
+        } else if ( std::strcmp( argv[i], "--numa" ) == 0 ) {
+            options.numa = true;
+        } else if ( std::strncmp( argv[i], "--checkpoint=", 13 ) == 0 ) {
+            options.checkpoint_file = argv[i] + 13;
+        } else if ( std::strncmp( argv[i], "--checkpoint-every=", 19 ) == 0 ) {
+            std::sscanf( argv[i] + 19, "%i", &options.checkpoint_every );
+        } else if ( std::strncmp( argv[i], "--checkpoint-seconds=", 21 ) == 0 ) {
+            std::sscanf( argv[i] + 21, "%lf", &options.checkpoint_seconds );
+        } else if ( std::strncmp( argv[i], "--resume=", 9 ) == 0 ) {
+            resume_file = argv[i] + 9;
+        } else if ( std::strncmp( argv[i], "--ensemble=", 11 ) == 0 ) {
+            std::sscanf( argv[i] + 11, "%i", &ensemble_boards );
+        } else if ( std::strncmp( argv[i], "--async-cancel-after=", 21 ) == 0 ) {
+            std::sscanf( argv[i] + 21, "%i", &async_cancel_after );
+        } else if ( std::strncmp( argv[i], "--trace=", 8 ) == 0 ) {
+            options.trace_file = argv[i] + 8;
+        } else if ( std::strncmp( argv[i], "--barrier=", 10 ) == 0 ) {
+            char const * name = argv[i] + 10;
+            if      ( std::strcmp( name, "central" ) == 0 )       { options.barrier = BarrierKind::kCentral; }
+            else if ( std::strcmp( name, "dissemination" ) == 0 ) { options.barrier = BarrierKind::kDissemination; }
+            else {
+                std::cout << "unknown barrier " << name << std::endl;
+                return false;
+            }
+        } else {
+            argv[kept++] = argv[i];
+        }
+    }
+    argc = kept;
+    return true;
+}
+
 int main( int argc, char ** argv ) 
 {
+    if ( !parse_options( argc, argv ) ) {
+        return 1;
+    }
+
+    if ( resume_file ) { // single argument - number of iterations of the whole run
+        if ( argc != 2 ) {
+            std::cout << "expected 1 parameter with --resume: number of iterations" << std::endl;
+            return 1;
+        }
+
+        int num_iter = 0;
+        std::sscanf(argv[1],"%i",&num_iter);
+
+        try {
+            int max_x, max_y;
+            LoadRleSize( resume_file, &max_x, &max_y );
+            std::vector< std::tuple<int,int> > final_population = resume( resume_file, num_iter, options );
+            draw( final_population, max_x, max_y );
+        } catch( const char* msg) {
+            std::cerr << msg << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
     if ( argc == 2 ) { // single argument - assume test number provided
 		int test = 0;
 		std::sscanf(argv[1],"%i",&test);
@@ -169,6 +377,11 @@ int main( int argc, char ** argv )
     int num_iter = 0;
     std::sscanf(argv[2],"%i",&num_iter);
 
-    test( argv[1], num_iter );
+    try {
+        test( argv[1], num_iter );
+    } catch( const char* msg) {
+        std::cerr << msg << std::endl;
+        return 1;
+    }
         return 0;
 }
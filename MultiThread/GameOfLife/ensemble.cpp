@@ -0,0 +1,268 @@
+/******************************************************************************/
+/*!
+\file   ensemble.cpp
+\author Isaac Hill
+\par    email: Isaac.Hill@digipen.edu
+\par    DigiPen login: Isaac.Hill
+\par    Course: CS355
+\par    Assignment #1
+\date   1/21/2020
+\brief
+This is the Implementation file for stepping many independent boards in one
+call. Small boards are packed side by side into bit packed sheets with a dead
+column and row between them, and every sheet is stepped start to finish by a
+single worker of a shared pool, so the boards never wait on a barrier.
+*/
+/******************************************************************************/
+
+#include "gol.h"
+#include "bitboard.h"
+#include "pool.h"
+
+#include <algorithm>
+
+namespace
+{
+	int const kSheetWidth = 1024; // cells across a sheet boards are packed into
+	int const kSheetHeight = 128; // rows down a sheet, two sheets fit in L1 per worker
+
+	/******************************************************************************/
+	/*!
+	Where the boards go on a sheet. Board i of a sheet has its cell (x, y) at
+	(i % slots_x * slot_width + x, i / slots_x * slot_height + y) and the
+	column and row after each board stay dead.
+	*/
+	/******************************************************************************/
+	struct SheetLayout
+	{
+		int slots_x;
+		int slots_y;
+		int slot_width;  // board plus the dead column after it
+		int slot_height; // board plus the dead row after it
+	};
+
+	/******************************************************************************/
+	/*!
+	Picks how many boards go on a sheet. A board on a torus needs the border
+	of the sheet for its wrapped cells, so it gets a sheet of its own.
+
+	\param max_x, max_y
+	Size of every board
+
+	\param boundary
+	What lies past the edges of the boards
+
+	\return
+	Layout of every sheet
+	*/
+	/******************************************************************************/
+	SheetLayout PlanSheets(int max_x, int max_y, Boundary boundary)
+	{
+		SheetLayout result;
+		result.slot_width = max_x + 1;
+		result.slot_height = max_y + 1;
+		result.slots_x = 1;
+		result.slots_y = 1;
+
+		if (boundary == Boundary::kDead)
+		{
+			result.slots_x = std::max(1, kSheetWidth / result.slot_width);
+			result.slots_y = std::max(1, kSheetHeight / result.slot_height);
+		}
+
+		return result;
+	}
+
+	/******************************************************************************/
+	/*!
+	Steps every board of a sheet one generation. Only the rows that belong to
+	a board are stepped, the dead rows between them are never written, and
+	the dead columns between boards are masked back off.
+
+	\param from
+	Sheet in the current generation
+
+	\param to
+	Sheet that receives the next generation
+
+	\param layout
+	Where the boards are
+
+	\param max_y
+	Rows of every board
+
+	\param columns
+	Per word of a row, the bits that belong to a board
+
+	\param rule
+	Rule to step with
+
+	\param wrap
+	The sheet holds one board on a torus
+	*/
+	/******************************************************************************/
+	void StepSheet(BitBoard const& from, BitBoard* to, SheetLayout const& layout, int max_y,
+	               std::vector<uint64_t> const& columns, Rule const& rule, bool wrap)
+	{
+		if (wrap)
+		{
+			StepRows(from, to, 0, max_y, rule);
+			WrapBorder(to, 0, max_y);
+			return;
+		}
+
+		for (int slot_y = 0; slot_y < layout.slots_y; ++slot_y)
+		{
+			int const y0 = slot_y * layout.slot_height;
+			StepRows(from, to, y0, y0 + max_y, rule);
+
+			if (layout.slots_x > 1)
+			{
+				for (int y = y0; y < y0 + max_y; ++y)
+				{
+					uint64_t* row = to->Row(y);
+					for (int w = 0; w < to->words; ++w)
+					{
+						row[w] &= columns[w];
+					}
+				}
+			}
+		}
+	}
+}
+
+/******************************************************************************/
+/*!
+Runs many independent boards of the same size at once. The boards are packed
+into sheets and the sheets are shared out to one pool of workers with work
+stealing, each worker steps its sheet through every generation before it
+takes the next one.
+
+\param initial_populations
+Coordinates of the initial live spaces of every board
+
+\param num_iter
+Number of iterations to run
+
+\param max_x
+max width of every board
+
+\param max_y
+max height of every board
+
+\param options
+Thread count, rule and boundary to use, the engine is not used
+
+\return
+coordinates of live cells at the end of every board, in the same order
+*/
+/******************************************************************************/
+std::vector< std::vector< std::tuple<int, int> > >
+run_ensemble(std::vector< std::vector< std::tuple<int, int> > > const& initial_populations, int num_iter, int max_x, int max_y,
+             Options const& options)
+{
+	CheckRule(options.rule);
+
+	int const num_boards = static_cast<int>(initial_populations.size());
+	std::vector< std::vector< std::tuple<int, int> > > results(num_boards);
+
+	if (options.stats)
+	{
+		*options.stats = Stats();
+		options.stats->generations = num_iter;
+	}
+
+	if (num_boards == 0 || max_x < 1 || max_y < 1)
+	{
+		return results;
+	}
+
+	bool const wrap = options.boundary == Boundary::kWrap;
+	SheetLayout const layout = PlanSheets(max_x, max_y, options.boundary);
+	int const per_sheet = layout.slots_x * layout.slots_y;
+	int const num_sheets = (num_boards + per_sheet - 1) / per_sheet;
+	int const sheet_width = layout.slots_x * layout.slot_width - 1;
+	int const sheet_height = layout.slots_y * layout.slot_height - 1;
+
+	//Bits of a sheet row that hold cells of a board rather than a dead column
+	std::vector<uint64_t> columns((sheet_width + 63) / 64, 0);
+	for (int slot = 0; slot < layout.slots_x; ++slot)
+	{
+		for (int x = slot * layout.slot_width; x < slot * layout.slot_width + max_x; ++x)
+		{
+			columns[x / 64] |= uint64_t(1) << (x % 64);
+		}
+	}
+
+	WorkerPool pool(options.num_threads, options.numa);
+	TaskQueues tasks(pool.Size());
+
+	//Every queue is filled before any worker starts, so one that runs dry early
+	//can steal from those still allocating their sheets
+	for (int worker = 0; worker < pool.Size(); ++worker)
+	{
+		tasks.Reset(worker, num_sheets);
+	}
+
+	pool.Run([&](int worker)
+	{
+		//Created on the worker, so the sheets are first touched where they are used
+		BitBoard sheets[2] = { CreateBitBoard(sheet_width, sheet_height), CreateBitBoard(sheet_width, sheet_height) };
+
+		int sheet;
+		while (tasks.Next(worker, &sheet))
+		{
+			int const first = sheet * per_sheet;
+			int const count = std::min(per_sheet, num_boards - first);
+
+			std::fill(sheets[0].cells.begin(), sheets[0].cells.end(), 0);
+			for (int i = 0; i < count; ++i)
+			{
+				int const x0 = i % layout.slots_x * layout.slot_width;
+				int const y0 = i / layout.slots_x * layout.slot_height;
+
+				std::vector< std::tuple<int, int> > const& population = initial_populations[first + i];
+				for (unsigned j = 0; j < population.size(); ++j)
+				{
+					int const x = x0 + std::get<0>(population[j]);
+					int const y = y0 + std::get<1>(population[j]);
+					sheets[0].Row(y)[x / 64] |= uint64_t(1) << (x % 64);
+				}
+			}
+			if (wrap)
+			{
+				WrapBorder(&sheets[0], 0, max_y);
+			}
+
+			int current = 0;
+			for (int i = 0; i < num_iter; ++i)
+			{
+				StepSheet(sheets[current], &sheets[1 - current], layout, max_y, columns, options.rule, wrap);
+				current = 1 - current;
+			}
+
+			//Same order as GetResult, column by column
+			for (int i = 0; i < count; ++i)
+			{
+				int const x0 = i % layout.slots_x * layout.slot_width;
+				int const y0 = i / layout.slots_x * layout.slot_height;
+
+				std::vector< std::tuple<int, int> >& result = results[first + i];
+				for (int x = 0; x < max_x; ++x)
+				{
+					uint64_t const bit = uint64_t(1) << ((x0 + x) % 64);
+					int const word = (x0 + x) / 64;
+					for (int y = 0; y < max_y; ++y)
+					{
+						if (sheets[current].Row(y0 + y)[word] & bit)
+						{
+							result.push_back(std::make_tuple(x, y));
+						}
+					}
+				}
+			}
+		}
+	});
+
+	return results;
+}
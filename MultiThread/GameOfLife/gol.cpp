@@ -13,20 +13,24 @@ This is the Implementation file for a game of life simulation
 /******************************************************************************/
 
 #include "gol.h"
+#include "board.h"
+#include "simulation.h"
+#include "rule.h"
+#include "checkpoint.h"
+#include "result.h"
+#include "async.h"
 
+#include <algorithm>
 #include <iostream>
+#include <memory>
+#include <deque>
+#include <unordered_map>
 #include <pthread.h>
 #include <semaphore.h>
 #include <chrono>
 #include <thread>
 #include <stdlib.h>
 
-enum State
-{
-	kDead,
-	kAlive
-};
-
 struct Arguments
 {
 	int x;
@@ -34,13 +38,12 @@ struct Arguments
 	int num_threads;
 	int iterations;
 	std::vector<std::vector<State>> *p_board;
+	Rule rule;
+	bool life; // rule is B3/S23, which keeps the original CalculateNewState
+	bool wrap; // the cell also writes its copies in the border on the other side
+	uint64_t totals[kPhaseCount]; // nanoseconds per phase written back by the thread, only with GOL_TRACE
 };
 
-//Forward declarartion of helper functions
-std::vector<std::vector<State>> CreateBoard(std::vector< std::tuple<int, int> > initial_population, int max_x, int max_y);
-State CalculateNewState(std::vector<std::vector<State>> *board, int x_pos, int y_pos);
-std::vector< std::tuple<int, int> > GetResult(std::vector<std::vector<State>> board);
-
 //Global thread variables
 int count = 0;
 pthread_mutex_t print_mutex;
@@ -48,6 +51,29 @@ sem_t count_mutex;
 sem_t barrier;
 sem_t barrier2;
 
+namespace
+{
+	// Time a thread spent in each phase, every call ends the current phase
+	// and starts the next. Costs nothing unless GOL_TRACE is defined
+	struct PhaseTotals
+	{
+		PhaseTotals() : last(kTraceEnabled ? Tracer::Now() : 0), totals() {}
+
+		void End(Phase phase)
+		{
+			if (kTraceEnabled)
+			{
+				uint64_t const now = Tracer::Now();
+				totals[static_cast<int>(phase)] += now - last;
+				last = now;
+			}
+		}
+
+		uint64_t last;
+		uint64_t totals[kPhaseCount];
+	};
+}
+
 /******************************************************************************/
 /*!
 Main logic for thread simulation
@@ -59,12 +85,14 @@ Arguments passed to thread
 void* Simulate(void * p)
 {
 	Arguments arg = *reinterpret_cast<Arguments*>(p);
+	PhaseTotals phases;
 
 	for (int i = 0; i < arg.iterations; ++i)
 	{
 		//Adjust counter inside mutex
 		//last thread signals barrier and resets barrier2
 		sem_wait(&count_mutex);
+		phases.End(Phase::kLock);
 		count = count + 1;
 		if (count == arg.num_threads) 
 		{
@@ -76,14 +104,17 @@ void* Simulate(void * p)
 		//First barrier
 		sem_wait(&barrier);
 		sem_post(&barrier);
+		phases.End(Phase::kBarrier);
 
 		// critical point
 		// Look at neighbors and find out fate
-		State new_state = CalculateNewState(arg.p_board, arg.x, arg.y);
+		State new_state = arg.life ? CalculateNewState(arg.p_board, arg.x, arg.y) : CalculateNewState(arg.p_board, arg.x, arg.y, arg.rule);
+		phases.End(Phase::kCompute);
 
 		//Adjust counter inside mutex
 		//last thread signals barrier2 and resets barrier
 		sem_wait(&count_mutex);
+		phases.End(Phase::kLock);
 		count = count - 1;
 		if (count == 0) 
 		{
@@ -95,12 +126,21 @@ void* Simulate(void * p)
 		//Second barrier
 		sem_wait(&barrier2);
 		sem_post(&barrier2);
+		phases.End(Phase::kBarrier);
 
 		//Critical point
 		//Write new state to board
 		(*arg.p_board)[arg.x][arg.y] = new_state;
+		if (arg.wrap)
+		{
+			WrapBorder(arg.p_board, arg.x - 1, arg.x, arg.y - 1, arg.y);
+		}
+		phases.End(Phase::kWriteBack);
 	}
 
+	//Written once at the end so the threads do not share cache lines while running
+	std::copy(phases.totals, phases.totals + kPhaseCount, reinterpret_cast<Arguments*>(p)->totals);
+
 	return NULL;
 }
 
@@ -120,15 +160,29 @@ max width of board
 \param max_y
 max height of board
 
+\param rule
+Rule every cell follows
+
+\param boundary
+What lies past the edges
+
+\param tracer
+Receives the time each cell's thread spent in each phase, null for none
+
 \return
 coordinates of live cells at end of simulation
 */
 /******************************************************************************/
-std::vector< std::tuple<int, int> > // return vector of coordinates of the alive cells of the final population
-run(std::vector< std::tuple<int, int> > initial_population, int num_iter, int max_x, int max_y)
+static std::vector< std::tuple<int, int> >
+RunCells(std::vector< std::tuple<int, int> > initial_population, int num_iter, int max_x, int max_y, Rule const& rule,
+         Boundary boundary, Tracer* tracer)
 {
 	//Create board from initial population
 	std::vector<std::vector<State>> Board = CreateBoard(initial_population, max_x, max_y);
+	if (boundary == Boundary::kWrap)
+	{
+		WrapBorder(&Board, 0, max_x, 0, max_y);
+	}
 
 	int const size = max_x * max_y;
 
@@ -156,6 +210,10 @@ run(std::vector< std::tuple<int, int> > initial_population, int num_iter, int ma
 		args[i].num_threads = size;
 		args[i].iterations = num_iter;
 		args[i].p_board = &Board;
+		args[i].rule = rule;
+		args[i].life = RuleBits(rule) == kLifeBits;
+		args[i].wrap = boundary == Boundary::kWrap;
+		std::fill(args[i].totals, args[i].totals + kPhaseCount, 0);
 
 		if (x > max_x)
 		{
@@ -175,6 +233,17 @@ run(std::vector< std::tuple<int, int> > initial_population, int num_iter, int ma
 		pthread_join(threads_id[i], 0);
 	}
 
+	if (tracer)
+	{
+		for (int i = 0; i < size; ++i)
+		{
+			for (int phase = 0; phase < kPhaseCount; ++phase)
+			{
+				tracer->Add(i, static_cast<Phase>(phase), args[i].totals[phase]);
+			}
+		}
+	}
+
 	delete[] args;
 	delete[] threads_id;
 
@@ -183,11 +252,14 @@ run(std::vector< std::tuple<int, int> > initial_population, int num_iter, int ma
 
 /******************************************************************************/
 /*!
-Creates the intitial board for the simulation
+Runs the original thread per cell simulation of B3/S23
 
 \param initial_population
 Coordinates of initial live spaces
 
+\param num_iter
+Number of iterations to run
+
 \param max_x
 max width of board
 
@@ -195,117 +267,1176 @@ max width of board
 max height of board
 
 \return
-Created board to use
+coordinates of live cells at end of simulation
 */
 /******************************************************************************/
-std::vector<std::vector<State>> CreateBoard(std::vector< std::tuple<int, int> > initial_population, int max_x, int max_y)
+std::vector< std::tuple<int, int> > // return vector of coordinates of the alive cells of the final population
+run(std::vector< std::tuple<int, int> > initial_population, int num_iter, int max_x, int max_y)
 {
-	//Create board and initialize to kDead
-	// +2 to x and y gives entire board a a 1 space border
-	std::vector<std::vector<State>> result(max_x + 2, std::vector<State>(max_y + 2, State::kDead));
+	return RunCells(initial_population, num_iter, max_x, max_y, kLife, Boundary::kDead, 0);
+}
 
-	int x, y;
-	//Set all initial spaces to kAlive
-	for (int i = 0; static_cast<unsigned int>(i) < initial_population.size(); ++i)
+namespace
+{
+	/******************************************************************************/
+	/*!
+	A list of coordinates seen as a board, used to hand the population given
+	to run to the engines
+	*/
+	/******************************************************************************/
+	class CellListView : public BoardView
 	{
-		std::tie(x, y) = initial_population[i];
+	public:
+		CellListView(std::vector< std::tuple<int, int> > const& cells, int max_x, int max_y)
+			: BoardView(max_x, max_y), cells_(cells)
+		{
+		}
 
-		//Increment x and y to account for border
-		++x;
-		++y;
+		bool Alive(int x, int y) const { return std::find(cells_.begin(), cells_.end(), std::make_tuple(x, y)) != cells_.end(); }
 
-		result[x][y] = State::kAlive;
-	}
+		void ForEachLive(std::function<void(int, int)> const& visit) const
+		{
+			for (unsigned i = 0; i < cells_.size(); ++i)
+			{
+				visit(std::get<0>(cells_[i]), std::get<1>(cells_[i]));
+			}
+		}
 
-	return result;
+	private:
+		std::vector< std::tuple<int, int> > const& cells_;
+	};
+
+	/******************************************************************************/
+	/*!
+	Whether a run can go straight to the original per cell run, which only
+	steps the board. Anything that looks at the board along the way or
+	times the threads goes through PerCellSimulation instead.
+
+	\param options
+	Options of the run
+
+	\return
+	True if nothing but the final board is wanted from the per cell engine
+	*/
+	/******************************************************************************/
+	bool PlainPerCell(Options const& options)
+	{
+		return options.engine == Engine::kPerCell && !options.observer && !options.checkpoint_file &&
+		       !options.detect_cycles && !options.trace_file && !kTraceEnabled;
+	}
 }
 
 /******************************************************************************/
 /*!
-Calculates new state based on surrounding states
+Runs the simulation on the engine picked by options
 
-\param board
-The board in it's current state
+\param initial_population
+Coordinates of initial live spaces
 
-\param x_pos
-x coordinate of space being checked
+\param num_iter
+Number of iterations to run
 
-\param y-pos
-y coordinate of space being checked
+\param max_x
+max width of board
+
+\param max_y
+max height of board
+
+\param options
+Engine and thread count to use, stats are written back through it
 
 \return
-The new state for the current location
+coordinates of live cells at end of simulation
 */
 /******************************************************************************/
-State CalculateNewState(std::vector<std::vector<State>> *board, int x_pos, int y_pos)
+std::vector< std::tuple<int, int> >
+run(std::vector< std::tuple<int, int> > initial_population, int num_iter, int max_x, int max_y, Options const& options)
 {
-	State old_state = (*board)[x_pos][y_pos];
-	State new_state = old_state;
-	int count = 0;
-
-	//Loops to look at neighboring spaces
-	for (int i = x_pos - 1; i <= x_pos + 1; ++i)
+	if (PlainPerCell(options))
 	{
-		for (int j = y_pos - 1; j <= y_pos + 1; ++j)
+		CheckRule(options.rule);
+
+		if (options.stats)
 		{
-			//Skip the space occupied by self
-			if (i != x_pos || j != y_pos)
-			{
-				//Increase count if neighboring space is alive
-				if ((*board)[i][j] == State::kAlive)
-				{
-					++count;
-				}
-					
-			}
+			*options.stats = Stats();
+			options.stats->generations = num_iter;
 		}
+
+		return RunCells(initial_population, num_iter, max_x, max_y, options.rule, options.boundary, 0);
 	}
 
-	//Determine new state from number of alive neighboring spaces
-	if (old_state == State::kDead)
+	return run(CellListView(initial_population, max_x, max_y), num_iter, options);
+}
+
+namespace
+{
+	/******************************************************************************/
+	/*!
+	Creates the engine and steps it, from a board that may already be some
+	generations into the run, which only changes the generation numbers
+	written into snapshots
+
+	\param initial
+	Board to start from
+
+	\param first_generation
+	Generation of the initial board, 0 unless resumed from a snapshot
+
+	\param num_iter
+	Number of iterations to run
+
+	\param options
+	Engine and thread count to use, stats are written back through it
+
+	\return
+	The engine holding the final board
+	*/
+	/******************************************************************************/
+	std::unique_ptr<Simulation> Simulate(BoardView const& initial, long long first_generation, int num_iter, Options const& options)
 	{
-		if (count == 3) 
+		std::unique_ptr<Simulation> simulation(CreateSimulation(initial, options));
+
+		Stats stats;
+		if (options.observer)
 		{
-			new_state = State::kAlive;
+			stats = AdvanceObserved(simulation.get(), num_iter, options);
+		}
+		else if (options.checkpoint_file)
+		{
+			stats = AdvanceCheckpointed(simulation.get(), first_generation, num_iter, options);
+		}
+		else if (options.detect_cycles)
+		{
+			stats = AdvanceDetectingCycles(simulation.get(), num_iter, options.cycle_history);
+		}
+		else
+		{
+			simulation->Advance(num_iter);
+			stats.generations = num_iter;
+		}
+
+		if (options.stats)
+		{
+			*options.stats = stats;
+			simulation->GetStats(options.stats);
+			simulation->GetTracer().Summarize(options.stats);
+		}
+
+		if (options.trace_file)
+		{
+			simulation->GetTracer().WriteChromeTrace(options.trace_file);
 		}
+
+		return simulation;
 	}
-	else 
+
+	/******************************************************************************/
+	/*!
+	Runs the simulation and copies the final board out as a list
+
+	\param initial
+	Board to start from
+
+	\param first_generation
+	Generation of the initial board, 0 unless resumed from a snapshot
+
+	\param num_iter
+	Number of iterations to run
+
+	\param options
+	Engine and thread count to use, stats are written back through it
+
+	\return
+	coordinates of live cells at end of simulation
+	*/
+	/******************************************************************************/
+	std::vector< std::tuple<int, int> >
+	RunFrom(BoardView const& initial, long long first_generation, int num_iter, Options const& options)
 	{
-		if (count < 2 || count > 3) 
+		if (PlainPerCell(options))
 		{
-			new_state = State::kDead; 
+			//The original run only takes a list of coordinates
+			std::vector< std::tuple<int, int> > cells;
+			initial.ForEachLive([&cells](int x, int y) { cells.push_back(std::make_tuple(x, y)); });
+			return run(cells, num_iter, initial.Width(), initial.Height(), options);
 		}
+
+		return Simulate(initial, first_generation, num_iter, options)->Result();
 	}
+}
 
-	return new_state;
+/******************************************************************************/
+/*!
+Runs the simulation on the engine picked by options, starting from any board
+such as a loaded pattern. The engine builds its own storage straight from the
+board without going through a list of coordinates.
+
+\param initial
+Board to start from
+
+\param num_iter
+Number of iterations to run
+
+\param options
+Engine and thread count to use, stats are written back through it
+
+\return
+coordinates of live cells at end of simulation
+*/
+/******************************************************************************/
+std::vector< std::tuple<int, int> >
+run(BoardView const& initial, int num_iter, Options const& options)
+{
+	return RunFrom(initial, 0, num_iter, options);
 }
 
 /******************************************************************************/
 /*!
-Gets coordinates of all live spaces on board
+Continues a run from the snapshot in a checkpoint file. The engines are all
+deterministic, so the result is the same as that of the run that wrote the
+snapshot. Stats and the observer count generations from the snapshot.
 
-\param board
-The board in the final state
+\param checkpoint_file
+Snapshot to continue from, written through Options::checkpoint_file
+
+\param num_iter
+Number of iterations of the whole run, including those before the snapshot
+
+\param options
+Engine and thread count to use, rule and boundary must be those of the run
+that wrote the snapshot, it can keep writing snapshots to the same file
 
 \return
-All coordinates of live spaces on board
+coordinates of live cells at end of simulation
 */
 /******************************************************************************/
-std::vector< std::tuple<int, int> > GetResult(std::vector<std::vector<State>> board)
+std::vector< std::tuple<int, int> >
+resume(char const* checkpoint_file, int num_iter, Options const& options)
 {
-	std::vector<std::tuple<int, int>> result;
+	long long generation = 0;
+	CellList const initial = LoadCheckpoint(checkpoint_file, options.rule, options.boundary, &generation);
+	if (generation > num_iter)
+	{
+		throw "checkpoint is past the end of the run";
+	}
+
+	return RunFrom(initial, generation, static_cast<int>(num_iter - generation), options);
+}
+
+/******************************************************************************/
+/*!
+Runs the simulation on the engine picked by options and keeps the final
+board where the engine left it, so nothing is copied out or sorted. Engines
+that do not keep the board bit packed have it packed once at the end, so
+the board must fit in memory bit packed, a huge sparse board needs run.
+
+\param initial
+Board to start from
+
+\param num_iter
+Number of iterations to run
+
+\param options
+Engine and thread count to use, stats are written back through it
+
+\return
+The final board, live cells come out of it in row major order
+
+\exception const char*
+If the board is too large to hold bit packed, before anything is run
+*/
+/******************************************************************************/
+RunResult run_bitmap(BoardView const& initial, int num_iter, Options const& options)
+{
+	if (!FitsBitPacked(initial.Width(), initial.Height()))
+	{
+		throw "board is too large for run_bitmap, use run";
+	}
+
+	return RunResult(Simulate(initial, 0, num_iter, options));
+}
+
+/******************************************************************************/
+/*!
+Runs the simulation on the engine picked by options and keeps the final
+board where the engine left it
+
+\param initial_population
+Coordinates of initial live spaces
+
+\param num_iter
+Number of iterations to run
+
+\param max_x
+max width of board
+
+\param max_y
+max height of board
+
+\param options
+Engine and thread count to use, stats are written back through it
+
+\return
+The final board, live cells come out of it in row major order
+*/
+/******************************************************************************/
+RunResult run_bitmap(std::vector< std::tuple<int, int> > const& initial_population, int num_iter, int max_x, int max_y,
+                     Options const& options)
+{
+	return run_bitmap(CellListView(initial_population, max_x, max_y), num_iter, options);
+}
+
+/******************************************************************************/
+/*!
+Starts the simulation on a thread of its own. The engine is created here, so
+a bad option throws from this call and not later from get.
+
+\param initial
+Board to start from, only read during the call
+
+\param num_iter
+Number of iterations to run
 
-	for (int i = 0; static_cast<unsigned int>(i) < board.size(); ++i)
+\param options
+Engine and thread count to use, stats and the trace file are written once
+the run is over
+
+\return
+Handle to cancel, poll and wait for the run
+*/
+/******************************************************************************/
+RunHandle run_async(BoardView const& initial, int num_iter, Options const& options)
+{
+	std::shared_ptr<Simulation> simulation(CreateSimulation(initial, options));
+	std::shared_ptr<RunProgress> progress(new RunProgress);
+	Stats* const stats = options.stats;
+	char const* const trace_file = options.trace_file;
+
+	std::future< std::vector< std::tuple<int, int> > > result = std::async(std::launch::async, [simulation, progress, num_iter, stats, trace_file]()
 	{
-		for (int j = 0; static_cast<unsigned int>(j) < board[i].size(); ++j)
+		Stats const done = AdvanceCancellable(simulation.get(), num_iter, progress.get());
+		if (stats)
 		{
-			if (board[i][j] == State::kAlive)
-			{
-				// -1 to set position back to 0 index due to border
-				result.push_back(std::make_tuple(i - 1, j - 1));
-			}
+			*stats = done;
+			simulation->GetStats(stats);
+			simulation->GetTracer().Summarize(stats);
 		}
-	}
 
-	return result;
-}
\ No newline at end of file
+		if (trace_file)
+		{
+			simulation->GetTracer().WriteChromeTrace(trace_file);
+		}
+		return simulation->Result();
+	});
+
+	return RunHandle(progress, std::move(result));
+}
+
+/******************************************************************************/
+/*!
+Starts the simulation on a thread of its own
+
+\param initial_population
+Coordinates of initial live spaces
+
+\param num_iter
+Number of iterations to run
+
+\param max_x
+max width of board
+
+\param max_y
+max height of board
+
+\param options
+Engine and thread count to use, stats and the trace file are written once
+the run is over
+
+\return
+Handle to cancel, poll and wait for the run
+*/
+/******************************************************************************/
+RunHandle run_async(std::vector< std::tuple<int, int> > const& initial_population, int num_iter, int max_x, int max_y,
+                    Options const& options)
+{
+	return run_async(CellListView(initial_population, max_x, max_y), num_iter, options);
+}
+
+/******************************************************************************/
+/*!
+Steps one generation at a time and remembers the hash of the last few
+boards. When a hash comes back the board is stepped one more period and
+compared, so a hash collision can never end the run early. Once the cycle is
+confirmed only the remainder of the period is stepped.
+
+\param simulation
+Board to step
+
+\param num_iter
+Number of iterations to run
+
+\param history
+Number of hashes to keep, the longest period that can be found
+
+\return
+Generations stepped and the cycle that was found, if any
+*/
+/******************************************************************************/
+Stats AdvanceDetectingCycles(Simulation* simulation, int num_iter, int history)
+{
+	Stats stats;
+	std::unordered_map<uint64_t, int> seen; // hash to the last generation it was seen at
+	std::deque<uint64_t> order;
+
+	int generation = 0;
+	seen[simulation->Hash()] = 0;
+	order.push_back(simulation->Hash());
+
+	while (generation < num_iter)
+	{
+		simulation->Advance(1);
+		++generation;
+
+		uint64_t hash = simulation->Hash();
+		std::unordered_map<uint64_t, int>::const_iterator it = seen.find(hash);
+
+		if (it != seen.end() && generation + (generation - it->second) <= num_iter)
+		{
+			//Step one more period and make sure the board really repeats
+			int const period = generation - it->second;
+			std::vector< std::tuple<int, int> > const before = simulation->Result();
+			simulation->Advance(period);
+
+			if (simulation->Result() == before)
+			{
+				int const remaining = (num_iter - generation - period) % period;
+				simulation->Advance(remaining);
+
+				stats.generations = generation + period + remaining;
+				stats.cycle_period = period;
+				stats.cycle_generation = generation;
+				return stats;
+			}
+
+			//A hash collision, the board moved on a period so its hash did too
+			generation += period;
+			hash = simulation->Hash();
+		}
+
+		seen[hash] = generation;
+		order.push_back(hash);
+		if (static_cast<int>(order.size()) > history)
+		{
+			//Only forget the hash if it was not seen again since
+			std::unordered_map<uint64_t, int>::iterator old = seen.find(order.front());
+			if (old != seen.end() && old->second <= generation - history)
+			{
+				seen.erase(old);
+			}
+			order.pop_front();
+		}
+	}
+
+	stats.generations = generation;
+	return stats;
+}
+
+/******************************************************************************/
+/*!
+Steps the board in runs of observe_every generations and shows the board to
+the observer after each run. Only used when an observer is set, so a run
+without one pays nothing for it.
+
+\param simulation
+Board to step
+
+\param num_iter
+Number of iterations to run
+
+\param options
+Observer and how often to call it
+
+\return
+Generations stepped
+*/
+/******************************************************************************/
+Stats AdvanceObserved(Simulation* simulation, int num_iter, Options const& options)
+{
+	int const every = options.observe_every > 0 ? options.observe_every : 1;
+
+	Stats stats;
+	while (stats.generations < num_iter)
+	{
+		int const steps = num_iter - stats.generations < every ? static_cast<int>(num_iter - stats.generations) : every;
+		simulation->Advance(steps);
+		stats.generations += steps;
+
+		options.observer(stats.generations, *simulation);
+	}
+
+	return stats;
+}
+
+namespace
+{
+	/******************************************************************************/
+	/*!
+	Steps a board in runs of generations sized by wall time, so a caller can
+	look at something between runs a few times per interval without reading
+	the clock every generation. Runs start at one generation, double while
+	one is over in under min_seconds and halve when one takes more than
+	max_seconds.
+	*/
+	/******************************************************************************/
+	class TimedRuns
+	{
+	public:
+		TimedRuns(double min_seconds, double max_seconds) : min_seconds_(min_seconds), max_seconds_(max_seconds), length_(1) {}
+
+		/******************************************************************************/
+		/*!
+		Steps one run and resizes the next by how long it took
+
+		\param simulation
+		Board to step
+
+		\param limit
+		Most generations the caller allows in this run
+
+		\return
+		Generations stepped
+		*/
+		/******************************************************************************/
+		int Advance(Simulation* simulation, int limit)
+		{
+			typedef std::chrono::steady_clock Clock;
+			int const kMaxRun = 1 << 20;
+
+			int const steps = std::min(length_, limit);
+
+			Clock::time_point const start = Clock::now();
+			simulation->Advance(steps);
+			double const took = std::chrono::duration<double>(Clock::now() - start).count();
+
+			//A run cut short by the caller says nothing about a longer one being too fast
+			if (took < min_seconds_ && steps == length_ && length_ < kMaxRun)
+			{
+				length_ *= 2;
+			}
+			else if (took > max_seconds_ && length_ > 1)
+			{
+				length_ /= 2;
+			}
+
+			return steps;
+		}
+
+	private:
+		double min_seconds_;
+		double max_seconds_;
+		int length_; // generations in the next run
+	};
+}
+
+/******************************************************************************/
+/*!
+Steps the board in runs and hands a snapshot to a background writer every
+checkpoint_every generations or checkpoint_seconds seconds, whichever comes
+first. With a time limit the runs are sized to take between a sixteenth and
+a quarter of it, so the clock is read a few times per snapshot and not
+every generation.
+
+\param simulation
+Board to step
+
+\param first_generation
+Generation of the board when it was created, snapshots count from the start
+of the run
+
+\param num_iter
+Number of iterations to run
+
+\param options
+Checkpoint file, how often to write it, rule and boundary to record
+
+\return
+Generations stepped
+*/
+/******************************************************************************/
+Stats AdvanceCheckpointed(Simulation* simulation, long long first_generation, int num_iter, Options const& options)
+{
+	typedef std::chrono::steady_clock Clock;
+
+	int const every = options.checkpoint_every;
+	double const seconds = options.checkpoint_seconds;
+
+	CheckpointWriter writer(options.checkpoint_file, options.rule, options.boundary);
+	TimedRuns runs(seconds / 16, seconds / 4);
+
+	Stats stats;
+	long long saved = 0; // generation of the last snapshot, counted in this call
+	Clock::time_point last_save = Clock::now();
+
+	while (stats.generations < num_iter)
+	{
+		int steps = static_cast<int>(num_iter - stats.generations);
+		if (every > 0)
+		{
+			steps = std::min(steps, static_cast<int>(every - (stats.generations - saved)));
+		}
+
+		if (seconds > 0)
+		{
+			steps = runs.Advance(simulation, steps);
+		}
+		else
+		{
+			simulation->Advance(steps);
+		}
+		stats.generations += steps;
+		Clock::time_point const now = Clock::now();
+
+		bool const due = (every > 0 && stats.generations - saved >= every) ||
+		                 (seconds > 0 && std::chrono::duration<double>(now - last_save).count() >= seconds);
+		if (due && stats.generations < num_iter)
+		{
+			writer.Save(*simulation, first_generation + stats.generations);
+			saved = stats.generations;
+			last_save = now;
+		}
+	}
+
+	writer.Finish();
+	return stats;
+}
+
+/******************************************************************************/
+/*!
+Steps the board in runs of generations and checks for a cancel between them,
+so the stepping itself never looks at the flag. The runs are sized to take
+between one and four milliseconds, so a cancel is seen within a few
+milliseconds and checking costs nothing next to the stepping.
+
+\param simulation
+Board to step
+
+\param num_iter
+Number of iterations to run
+
+\param progress
+Cancel flag to check and generation count to keep up to date
+
+\return
+Generations stepped, fewer than num_iter if cancelled
+*/
+/******************************************************************************/
+Stats AdvanceCancellable(Simulation* simulation, int num_iter, RunProgress* progress)
+{
+	TimedRuns runs(0.001, 0.004);
+
+	Stats stats;
+	while (stats.generations < num_iter && !progress->cancelled.load(std::memory_order_relaxed))
+	{
+		stats.generations += runs.Advance(simulation, static_cast<int>(num_iter - stats.generations));
+		progress->generation.store(stats.generations, std::memory_order_relaxed);
+	}
+
+	return stats;
+}
+
+/******************************************************************************/
+/*!
+Visits the live cells through Result, which copies them out once
+
+\param visit
+Called with the coordinates of each live cell
+*/
+/******************************************************************************/
+void Simulation::ForEachLive(std::function<void(int, int)> const& visit) const
+{
+	std::vector< std::tuple<int, int> > const cells = Result();
+	for (unsigned i = 0; i < cells.size(); ++i)
+	{
+		visit(std::get<0>(cells[i]), std::get<1>(cells[i]));
+	}
+}
+
+/******************************************************************************/
+/*!
+Hash of the current generation built from its live cells, engines that can
+hash their own storage faster override it
+
+\return
+Hash of the live cells
+*/
+/******************************************************************************/
+uint64_t Simulation::Hash() const
+{
+	std::vector< std::tuple<int, int> > const cells = Result();
+
+	uint64_t hash = cells.size();
+	for (unsigned i = 0; i < cells.size(); ++i)
+	{
+		uint64_t const x = static_cast<uint32_t>(std::get<0>(cells[i]));
+		uint64_t const y = static_cast<uint32_t>(std::get<1>(cells[i]));
+		hash = HashWord(hash, (y << 32) | x);
+	}
+
+	return hash;
+}
+
+namespace
+{
+	/******************************************************************************/
+	/*!
+	The original thread per cell run behind the Simulation interface, so it can
+	be stepped a few generations at a time and observed like the other engines
+	*/
+	/******************************************************************************/
+	class PerCellSimulation : public Simulation
+	{
+	public:
+		PerCellSimulation(BoardView const& initial, Options const& options)
+			: Simulation(initial.Width(), initial.Height()), rule_(options.rule), boundary_(options.boundary)
+		{
+			initial.ForEachLive([this](int x, int y) { population_.push_back(std::make_tuple(x, y)); });
+			std::sort(population_.begin(), population_.end());
+
+			//One thread per cell, too many for a ring each
+			tracer_.StartTotals(initial.Width() * initial.Height());
+		}
+
+		void Advance(int generations)
+		{
+			population_ = RunCells(population_, generations, Width(), Height(), rule_, boundary_, kTraceEnabled ? &tracer_ : 0);
+		}
+		std::vector< std::tuple<int, int> > Result() const { return population_; }
+		bool Alive(int x, int y) const { return std::binary_search(population_.begin(), population_.end(), std::make_tuple(x, y)); }
+
+	private:
+		std::vector< std::tuple<int, int> > population_; // sorted, as GetResult returns it
+		Rule rule_;
+		Boundary boundary_;
+	};
+}
+
+/******************************************************************************/
+/*!
+Creates the engine picked by options
+
+\param initial
+Board to start from
+
+\param options
+Engine and thread count to use
+
+\return
+Newly allocated simulation, owned by the caller
+*/
+/******************************************************************************/
+Simulation* CreateSimulation(BoardView const& initial, Options const& options)
+{
+	CheckRule(options.rule);
+
+	switch (options.engine)
+	{
+	case Engine::kBitPacked:
+		return CreateBitSimulation(initial, options);
+	case Engine::kSimd:
+		return CreateSimdSimulation(initial, options);
+	case Engine::kHashLife:
+		return CreateHashLifeSimulation(initial, options);
+	case Engine::kActive:
+		return CreateActiveSimulation(initial, options);
+	case Engine::kSparse:
+		return CreateSparseSimulation(initial, options);
+	case Engine::kSharded:
+		return CreateShardedSimulation(initial, options);
+	case Engine::kLookup:
+		return CreateLookupSimulation(initial, options);
+	case Engine::kPerCell:
+		return new PerCellSimulation(initial, options);
+	case Engine::kTiled:
+	default:
+		return CreateTiledSimulation(initial, options);
+	}
+}
+
+/******************************************************************************/
+/*!
+Splits the board into near square tiles, one per worker
+
+\param max_x
+max width of board
+
+\param max_y
+max height of board
+
+\param num_tiles
+Number of tiles wanted, fewer are returned if the board has fewer cells
+
+\return
+Tiles covering the whole board without overlap
+*/
+/******************************************************************************/
+std::vector<Tile> SplitTiles(int max_x, int max_y, int num_tiles)
+{
+	std::vector<Tile> result;
+
+	if (num_tiles > max_x * max_y)
+	{
+		num_tiles = max_x * max_y;
+	}
+	if (num_tiles < 1)
+	{
+		return result;
+	}
+
+	//Pick the factorization whose tiles are closest to square
+	int tiles_x = 1;
+	double best = -1.0;
+	for (int i = 1; i <= num_tiles; ++i)
+	{
+		if (num_tiles % i != 0 || i > max_x || num_tiles / i > max_y)
+		{
+			continue;
+		}
+
+		double const w = static_cast<double>(max_x) / i;
+		double const h = static_cast<double>(max_y) / (num_tiles / i);
+		double const score = w < h ? w / h : h / w;
+		if (score > best)
+		{
+			best = score;
+			tiles_x = i;
+		}
+	}
+
+	//Prime counts larger than a side fall back to strips
+	if (best < 0.0)
+	{
+		tiles_x = 1;
+		if (num_tiles > max_y)
+		{
+			num_tiles = max_y;
+		}
+	}
+
+	int const tiles_y = num_tiles / tiles_x;
+
+	for (int j = 0; j < tiles_y; ++j)
+	{
+		for (int i = 0; i < tiles_x; ++i)
+		{
+			Tile tile;
+			tile.x0 = max_x * i / tiles_x;
+			tile.x1 = max_x * (i + 1) / tiles_x;
+			tile.y0 = max_y * j / tiles_y;
+			tile.y1 = max_y * (j + 1) / tiles_y;
+			result.push_back(tile);
+		}
+	}
+
+	return result;
+}
+
+/******************************************************************************/
+/*!
+Creates the intitial board for the simulation
+
+\param initial_population
+Coordinates of initial live spaces
+
+\param max_x
+max width of board
+
+\param max_y
+max height of board
+
+\return
+Created board to use
+*/
+/******************************************************************************/
+std::vector<std::vector<State>> CreateBoard(std::vector< std::tuple<int, int> > initial_population, int max_x, int max_y)
+{
+	//Create board and initialize to kDead
+	// +2 to x and y gives entire board a a 1 space border
+	std::vector<std::vector<State>> result(max_x + 2, std::vector<State>(max_y + 2, State::kDead));
+
+	int x, y;
+	//Set all initial spaces to kAlive
+	for (int i = 0; static_cast<unsigned int>(i) < initial_population.size(); ++i)
+	{
+		std::tie(x, y) = initial_population[i];
+
+		//Increment x and y to account for border
+		++x;
+		++y;
+
+		result[x][y] = State::kAlive;
+	}
+
+	return result;
+}
+
+/******************************************************************************/
+/*!
+Creates board from any initial board
+
+\param initial
+Board to start from
+
+\return
+Created board to use
+*/
+/******************************************************************************/
+std::vector<std::vector<State>> CreateBoard(BoardView const& initial)
+{
+	std::vector<std::vector<State>> result(initial.Width() + 2, std::vector<State>(initial.Height() + 2, State::kDead));
+
+	//Shift by one to account for border
+	initial.ForEachLive([&result](int x, int y) { result[x + 1][y + 1] = State::kAlive; });
+
+	return result;
+}
+
+/******************************************************************************/
+/*!
+Copies the edge cells of a rectangle into the border on the opposite side, so
+the next generation sees a torus and CalculateNewState needs no wrapping. A
+worker calls it on the cells it just wrote, the corners of the border go with
+the tile that owns the opposite corner cell.
+
+\param board
+Board that was just written
+
+\param x0, x1
+First column and one past the last column that were written, not counting
+the border
+
+\param y0, y1
+First row and one past the last row that were written
+*/
+/******************************************************************************/
+void WrapBorder(Board* board, int x0, int x1, int y0, int y1)
+{
+	Board& cells = *board;
+	int const width = static_cast<int>(cells.size()) - 2;
+	int const height = static_cast<int>(cells[0].size()) - 2;
+	if (width < 1 || height < 1)
+	{
+		return;
+	}
+
+	//Cell (x, y) is at [x + 1][y + 1]
+	for (int y = y0 + 1; y <= y1; ++y)
+	{
+		if (x0 == 0)
+		{
+			cells[width + 1][y] = cells[1][y];
+		}
+		if (x1 == width)
+		{
+			cells[0][y] = cells[width][y];
+		}
+	}
+	for (int x = x0 + 1; x <= x1; ++x)
+	{
+		if (y0 == 0)
+		{
+			cells[x][height + 1] = cells[x][1];
+		}
+		if (y1 == height)
+		{
+			cells[x][0] = cells[x][height];
+		}
+	}
+
+	if (x0 == 0 && y0 == 0)
+	{
+		cells[width + 1][height + 1] = cells[1][1];
+	}
+	if (x1 == width && y0 == 0)
+	{
+		cells[0][height + 1] = cells[width][1];
+	}
+	if (x0 == 0 && y1 == height)
+	{
+		cells[width + 1][0] = cells[1][height];
+	}
+	if (x1 == width && y1 == height)
+	{
+		cells[0][0] = cells[width][height];
+	}
+}
+
+/******************************************************************************/
+/*!
+Calculates new state based on surrounding states
+
+\param board
+The board in it's current state
+
+\param x_pos
+x coordinate of space being checked
+
+\param y-pos
+y coordinate of space being checked
+
+\return
+The new state for the current location
+*/
+/******************************************************************************/
+State CalculateNewState(std::vector<std::vector<State>> *board, int x_pos, int y_pos)
+{
+	State old_state = (*board)[x_pos][y_pos];
+	State new_state = old_state;
+	int count = 0;
+
+	//Loops to look at neighboring spaces
+	for (int i = x_pos - 1; i <= x_pos + 1; ++i)
+	{
+		for (int j = y_pos - 1; j <= y_pos + 1; ++j)
+		{
+			//Skip the space occupied by self
+			if (i != x_pos || j != y_pos)
+			{
+				//Increase count if neighboring space is alive
+				if ((*board)[i][j] == State::kAlive)
+				{
+					++count;
+				}
+					
+			}
+		}
+	}
+
+	//Determine new state from number of alive neighboring spaces
+	if (old_state == State::kDead)
+	{
+		if (count == 3) 
+		{
+			new_state = State::kAlive;
+		}
+	}
+	else 
+	{
+		if (count < 2 || count > 3) 
+		{
+			new_state = State::kDead; 
+		}
+	}
+
+	return new_state;
+}
+
+/******************************************************************************/
+/*!
+Calculates new state based on surrounding states under any B/S rule
+
+\param board
+The board in it's current state
+
+\param x_pos
+x coordinate of space being checked
+
+\param y_pos
+y coordinate of space being checked
+
+\param rule
+Rule to follow
+
+\return
+The new state for the current location
+*/
+/******************************************************************************/
+State CalculateNewState(std::vector<std::vector<State>> *board, int x_pos, int y_pos, Rule const& rule)
+{
+	int const self = (*board)[x_pos][y_pos] == State::kAlive ? 1 : 0;
+	int count = -self;
+
+	//Count the whole 3x3 block, then take self back out
+	for (int i = x_pos - 1; i <= x_pos + 1; ++i)
+	{
+		for (int j = y_pos - 1; j <= y_pos + 1; ++j)
+		{
+			count += (*board)[i][j] == State::kAlive ? 1 : 0;
+		}
+	}
+
+	return ((RuleBits(rule) >> (count + 9 * self)) & 1) ? State::kAlive : State::kDead;
+}
+
+/******************************************************************************/
+/*!
+Gets coordinates of all live spaces on board
+
+\param board
+The board in the final state
+
+\return
+All coordinates of live spaces on board
+*/
+/******************************************************************************/
+std::vector< std::tuple<int, int> > GetResult(Board const& board)
+{
+	std::vector<std::tuple<int, int>> result;
+
+	//The border is skipped, on a torus it holds copies of the opposite edges
+	for (int i = 1; static_cast<unsigned int>(i) + 1 < board.size(); ++i)
+	{
+		for (int j = 1; static_cast<unsigned int>(j) + 1 < board[i].size(); ++j)
+		{
+			if (board[i][j] == State::kAlive)
+			{
+				// -1 to set position back to 0 index due to border
+				result.push_back(std::make_tuple(i - 1, j - 1));
+			}
+		}
+	}
+
+	return result;
+}
+
+/******************************************************************************/
+/*!
+Splits the board into horizontal bands of whole rows, one per worker
+
+\param max_x
+max width of board
+
+\param max_y
+max height of board
+
+\param num_bands
+Number of bands wanted, fewer are returned if the board has fewer rows
+
+\return
+Bands covering the whole board without overlap
+*/
+/******************************************************************************/
+std::vector<Tile> SplitBands(int max_x, int max_y, int num_bands)
+{
+	std::vector<Tile> result;
+
+	if (num_bands > max_y)
+	{
+		num_bands = max_y;
+	}
+	if (max_x < 1)
+	{
+		num_bands = 0;
+	}
+
+	for (int j = 0; j < num_bands; ++j)
+	{
+		Tile band;
+		band.x0 = 0;
+		band.x1 = max_x;
+		band.y0 = max_y * j / num_bands;
+		band.y1 = max_y * (j + 1) / num_bands;
+		result.push_back(band);
+	}
+
+	return result;
+}
@@ -8,10 +8,165 @@
 #ifndef GOL_H
 #define GOL_H
 
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <vector>
 #include <tuple>
 
 std::vector< std::tuple<int,int> > // return vector of coordinates of the alive cells of the final population
 run( std::vector< std::tuple<int,int> > initial_population, int num_iter, int max_x, int max_y );
 
+// Engines that can step the board
+enum class Engine
+{
+	kPerCell,   // one thread per cell, the original assignment model
+	kTiled,     // fixed size worker pool, each worker owns a rectangular tile
+	kBitPacked, // 64 cells per word stepped with bitwise adders, workers own row bands
+	kSimd,      // byte per cell stepped 32 at a time, AVX2, SSE2 or scalar picked at startup
+	kHashLife,  // memoized quadtree that skips ahead 2^j generations at once, single threaded
+	kActive,    // small tiles, only those next to a tile that changed last generation are stepped
+	kSparse,    // hash map of 64x64 bit packed chunks, memory follows the live area not the board
+	kSharded,   // bit packed row bands in separate processes, edge rows swapped over Unix sockets
+	kLookup     // bit packed row bands stepped 2x2 cells at a time through a 4x4 window table, no SIMD needed
+};
+
+// How the tiled engine stores the board between generations
+enum class Buffering
+{
+	kInPlace,       // one board, every generation has a read phase and a write phase
+	kDoubleBuffered // two flat aligned grids swapped every generation, one barrier per generation
+};
+
+// What lies past the edges of the board
+enum class Boundary
+{
+	kDead, // a border of cells that are always dead
+	kWrap  // opposite edges are joined, the board is a torus
+};
+
+// How the pooled engines wait for each other between generations
+enum class BarrierKind
+{
+	kCentral,      // one shared counter, sense reversing, spins then sleeps on a futex
+	kDissemination // log2(n) rounds of pairwise signals, no shared counter for many threads
+};
+
+// How the active engine hands out its tiles
+enum class Scheduling
+{
+	kStatic,      // rows of tiles dealt out round robin, fixed for the whole run
+	kWorkStealing // every generation each worker starts on its own share and steals when it runs dry
+};
+
+// Filled in by run when Options::stats is set
+struct Stats
+{
+	Stats() : generations(0), active_tiles(0), total_tiles(0), cycle_period(0), cycle_generation(0), steals(0),
+	          compute_seconds(0), barrier_seconds(0), write_back_seconds(0), lock_seconds(0), imbalance(0),
+	          barrier_p50_us(0), barrier_p99_us(0), local_pages(0), remote_pages(0) {}
+
+	long long generations;      // generations actually stepped, less than asked when a cycle was skipped
+	long long active_tiles;     // tiles the active engine stepped, summed over all generations
+	long long total_tiles;      // tiles on the board, summed over all generations
+	int cycle_period;           // period of the cycle found by detect_cycles, 0 if none, 1 for a still life
+	long long cycle_generation; // generation at which the cycle was found
+	long long steals;           // tasks the work stealing scheduler moved to another worker
+
+	// Only filled in when built with GOL_TRACE
+	double compute_seconds;     // summed over all threads
+	double barrier_seconds;
+	double write_back_seconds;
+	double lock_seconds;        // waiting for count_mutex, only the per cell engine has it
+	double imbalance;           // compute time of the busiest thread over the mean, 1 is even
+	double barrier_p50_us;      // median wait in a barrier
+	double barrier_p99_us;
+
+	// Only filled in with Options::numa by the bitpacked, simd and lookup engines
+	long long local_pages;      // pages of a band and its halo rows on the node of the worker stepping it
+	long long remote_pages;     // the same pages on another node, only the halo rows once placed
+};
+
+// Read only look at a board, a loaded pattern or a running simulation during the observer call
+class BoardView
+{
+public:
+	BoardView(int width, int height) : width_(width), height_(height) {}
+	virtual ~BoardView() {}
+
+	int Width() const { return width_; }
+	int Height() const { return height_; }
+
+	virtual bool Alive(int x, int y) const = 0;
+
+	// Calls visit(x, y) for every live cell, the order depends on the engine
+	virtual void ForEachLive(std::function<void(int, int)> const& visit) const = 0;
+
+private:
+	int width_;
+	int height_;
+};
+
+// Outer totalistic rule, bit n of birth is set when a dead cell with n live
+// neighbors comes alive and bit n of survive when a live one stays alive
+struct Rule
+{
+	uint16_t birth;
+	uint16_t survive;
+};
+
+Rule const kLife = { 1 << 3, (1 << 2) | (1 << 3) }; // B3/S23
+
+// Reads a rule written as "B36/S23", throws a message if it is malformed or has
+// B0, which would bring the dead space around the board to life
+Rule ParseRule(char const* text);
+
+// Called with the generation number and the board after it was stepped
+typedef std::function<void(long long generation, BoardView const& board)> Observer;
+
+struct Options
+{
+	Options() : engine(Engine::kPerCell), num_threads(0), num_shards(0), rule(kLife), boundary(Boundary::kDead), buffering(Buffering::kInPlace),
+	            hashlife_cache_bytes(size_t(256) << 20), active_tile_size(32),
+	            detect_cycles(false), cycle_history(64), temporal_block(1),
+	            barrier(BarrierKind::kCentral), scheduling(Scheduling::kStatic), numa(false),
+	            observe_every(1), checkpoint_file(0), checkpoint_every(0), checkpoint_seconds(0), trace_file(0), stats(0) {}
+
+	Engine engine;
+	int num_threads;             // workers for pooled engines, 0 uses hardware concurrency
+	int num_shards;              // processes for the sharded engine, 0 uses hardware concurrency
+	Rule rule;                   // every engine follows it, B0 rules are refused
+	Boundary boundary;           // every engine but HashLife can wrap
+	Buffering buffering;         // only used by the tiled engine
+	size_t hashlife_cache_bytes; // HashLife node cache is garbage collected past this size
+	int active_tile_size;        // side of the tiles the active engine tracks
+	bool detect_cycles;          // hash every generation and skip ahead once the board repeats
+	int cycle_history;           // generations of hashes kept, longest period that can be found
+	int temporal_block;          // generations the double buffered tiled engine steps per barrier
+	BarrierKind barrier;         // barrier the pooled engines sync with
+	Scheduling scheduling;       // only used by the active engine
+	bool numa;                   // pin pooled workers to cores, banded engines first touch each band on its worker
+	Observer observer;           // optional, called every observe_every generations and after the last
+	int observe_every;           // generations between observer calls, detect_cycles is off while observed
+	char const* checkpoint_file; // optional, snapshots are written here as RLE in the background unless observed, see resume
+	int checkpoint_every;        // generations between snapshots, 0 for none
+	double checkpoint_seconds;   // seconds between snapshots, 0 for none, detect_cycles is off while either is set
+	char const* trace_file;      // optional, with GOL_TRACE a Chrome trace JSON of every phase is written here
+	Stats* stats;                // optional, receives statistics about the run
+};
+
+std::vector< std::tuple<int,int> > // same as above, with the engine picked by options
+run( std::vector< std::tuple<int,int> > initial_population, int num_iter, int max_x, int max_y, Options const& options );
+
+std::vector< std::tuple<int,int> > // same as above, starting from any board such as a loaded Pattern
+run( BoardView const& initial, int num_iter, Options const& options );
+
+std::vector< std::tuple<int,int> > // same as above, continuing a run from the snapshot in a checkpoint file
+resume( char const* checkpoint_file, int num_iter, Options const& options ); // num_iter counts from the start of the run,
+                                                                              // rule and boundary must match the snapshot
+
+std::vector< std::vector< std::tuple<int,int> > > // final population of every board, in the same order
+run_ensemble( std::vector< std::vector< std::tuple<int,int> > > const& initial_populations, int num_iter, int max_x, int max_y,
+              Options const& options ); // boards share one worker pool, only num_threads, rule, boundary and stats are used
+
 #endif
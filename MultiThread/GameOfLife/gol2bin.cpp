@@ -0,0 +1,54 @@
+/******************************************************************************/
+/*!
+\file   gol2bin.cpp
+\author Isaac Hill
+\par    email: Isaac.Hill@digipen.edu
+\par    DigiPen login: Isaac.Hill
+\par    Course: CS355
+\par    Assignment #1
+\date   1/21/2020
+\brief
+Converts a starting board in the driver's text format or in RLE into the
+binary bitmap format, which loads with one copy per row
+*/
+/******************************************************************************/
+
+#include "pattern.h"
+
+#include <iostream>
+
+/******************************************************************************/
+/*!
+Converts the file named by the first argument into the second
+
+\param argc
+Number of arguments
+
+\param argv
+Input file and output file
+
+\return
+0 on success
+*/
+/******************************************************************************/
+int main(int argc, char** argv)
+{
+	if (argc != 3)
+	{
+		std::cout << "usage: gol2bin <input, text or .rle> <output .golb>" << std::endl;
+		return 1;
+	}
+
+	try
+	{
+		Pattern const pattern = LoadPattern(argv[1]);
+		SaveBitmap(pattern, argv[2]);
+	}
+	catch (const char* msg)
+	{
+		std::cerr << msg << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
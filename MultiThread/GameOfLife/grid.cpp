@@ -0,0 +1,971 @@
+/******************************************************************************/
+/*!
+\file   grid.cpp
+\author Isaac Hill
+\par    email: Isaac.Hill@digipen.edu
+\par    DigiPen login: Isaac.Hill
+\par    Course: CS355
+\par    Assignment #1
+\date   1/21/2020
+\brief
+This is the Implementation file for the byte per cell board, its AVX2, SSE2
+and scalar stepping kernels, and the engine that runs them on the pool
+*/
+/******************************************************************************/
+
+#include "grid.h"
+#include "rule.h"
+#include "simulation.h"
+#include "pool.h"
+#include "numa.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define GOL_X86 1
+#endif
+
+/******************************************************************************/
+/*!
+Creates an empty grid
+*/
+/******************************************************************************/
+ByteGrid::ByteGrid() : width_(0), height_(0), stride_(0), data_(0)
+{
+}
+
+/******************************************************************************/
+/*!
+Creates a grid with every cell dead
+
+\param width
+Number of cells in a row
+
+\param height
+Number of rows
+*/
+/******************************************************************************/
+ByteGrid::ByteGrid(int width, int height) : width_(width), height_(height), stride_(0), data_(0)
+{
+	//Room for the padding on both sides, rounded up to whole cache lines
+	int const cells = (width + kPad - 1) / kPad * kPad;
+	stride_ = (kPad + cells + kPad + kAlign - 1) / kAlign * kAlign;
+
+	size_t const size = static_cast<size_t>(stride_) * (height + 2);
+	void* p = 0;
+	if (posix_memalign(&p, kAlign, size) != 0)
+	{
+		throw "out of memory";
+	}
+
+	data_ = static_cast<uint8_t*>(p);
+	std::memset(data_, 0, size);
+}
+
+/******************************************************************************/
+/*!
+Copy constructor
+
+\param rhs
+Grid to copy
+*/
+/******************************************************************************/
+ByteGrid::ByteGrid(ByteGrid const& rhs) : ByteGrid(rhs.width_, rhs.height_)
+{
+	std::memcpy(data_, rhs.data_, static_cast<size_t>(stride_) * (height_ + 2));
+}
+
+/******************************************************************************/
+/*!
+Move constructor, leaves rhs empty
+
+\param rhs
+Grid to take the cells from
+*/
+/******************************************************************************/
+ByteGrid::ByteGrid(ByteGrid&& rhs) : width_(rhs.width_), height_(rhs.height_), stride_(rhs.stride_), data_(rhs.data_)
+{
+	rhs.width_ = rhs.height_ = rhs.stride_ = 0;
+	rhs.data_ = 0;
+}
+
+/******************************************************************************/
+/*!
+Frees the cells
+*/
+/******************************************************************************/
+ByteGrid::~ByteGrid()
+{
+	std::free(data_);
+}
+
+/******************************************************************************/
+/*!
+Assignment operator
+
+\param rhs
+Grid to copy or move from
+
+\return
+This grid
+*/
+/******************************************************************************/
+ByteGrid& ByteGrid::operator=(ByteGrid rhs)
+{
+	std::swap(width_, rhs.width_);
+	std::swap(height_, rhs.height_);
+	std::swap(stride_, rhs.stride_);
+	std::swap(data_, rhs.data_);
+
+	return *this;
+}
+
+/******************************************************************************/
+/*!
+Creates a byte grid from the initial board
+
+\param initial
+Board to start from
+
+\return
+Created grid to use
+*/
+/******************************************************************************/
+ByteGrid CreateByteGrid(BoardView const& initial)
+{
+	ByteGrid result(initial.Width(), initial.Height());
+
+	initial.ForEachLive([&result](int x, int y)
+	{
+		result.Row(y)[x] = 1;
+	});
+
+	return result;
+}
+
+/******************************************************************************/
+/*!
+Copies the edge cells of a rectangle into the dead border on the opposite
+side, so the next step sees a torus without any wrapping in the kernels. A
+worker calls it on the cells it just wrote, the corners go with the tile
+that owns the corner cell.
+
+\param grid
+Grid that was just written
+
+\param x0, x1
+First column and one past the last column that were written
+
+\param y0, y1
+First row and one past the last row that were written
+*/
+/******************************************************************************/
+void WrapBorder(ByteGrid* grid, int x0, int x1, int y0, int y1)
+{
+	int const width = grid->Width();
+	int const height = grid->Height();
+	if (width < 1 || height < 1)
+	{
+		return;
+	}
+
+	for (int y = y0; y < y1; ++y)
+	{
+		uint8_t* row = grid->Row(y);
+		if (x0 == 0)
+		{
+			row[width] = row[0];
+		}
+		if (x1 == width)
+		{
+			row[-1] = row[width - 1];
+		}
+	}
+
+	//The corner cells are only written by the tile that holds the opposite corner
+	if (y0 == 0)
+	{
+		std::memcpy(grid->Row(height) + x0, grid->Row(0) + x0, x1 - x0);
+		if (x0 == 0)
+		{
+			grid->Row(height)[width] = grid->Row(0)[0];
+		}
+		if (x1 == width)
+		{
+			grid->Row(height)[-1] = grid->Row(0)[width - 1];
+		}
+	}
+	if (y1 == height)
+	{
+		std::memcpy(grid->Row(-1) + x0, grid->Row(height - 1) + x0, x1 - x0);
+		if (x0 == 0)
+		{
+			grid->Row(-1)[width] = grid->Row(height - 1)[0];
+		}
+		if (x1 == width)
+		{
+			grid->Row(-1)[-1] = grid->Row(height - 1)[width - 1];
+		}
+	}
+}
+
+/******************************************************************************/
+/*!
+Gets coordinates of all live spaces on the grid, in the same order as the
+nested vector version
+
+\param grid
+The grid in the final state
+
+\return
+All coordinates of live spaces on the grid
+*/
+/******************************************************************************/
+std::vector< std::tuple<int, int> > GetResult(ByteGrid const& grid)
+{
+	std::vector< std::tuple<int, int> > result;
+
+	for (int x = 0; x < grid.Width(); ++x)
+	{
+		for (int y = 0; y < grid.Height(); ++y)
+		{
+			if (grid.Row(y)[x])
+			{
+				result.push_back(std::make_tuple(x, y));
+			}
+		}
+	}
+
+	return result;
+}
+
+/******************************************************************************/
+/*!
+Visits every live cell row by row, eight dead cells are skipped at a time
+
+\param grid
+Grid to scan
+
+\param visit
+Called with the coordinates of each live cell
+*/
+/******************************************************************************/
+void ForEachLive(ByteGrid const& grid, std::function<void(int, int)> const& visit)
+{
+	for (int y = 0; y < grid.Height(); ++y)
+	{
+		uint8_t const* row = grid.Row(y);
+
+		//The padding after the row is dead except for a wrapped border cell, so
+		//the last word may run past the width once that cell is masked off
+		for (int x = 0; x < grid.Width(); x += 8)
+		{
+			uint64_t word;
+			std::memcpy(&word, row + x, sizeof(word));
+			if (grid.Width() - x < 8)
+			{
+				word &= (uint64_t(1) << (8 * (grid.Width() - x))) - 1;
+			}
+			while (word)
+			{
+				int const bit = __builtin_ctzll(word);
+				visit(x + bit / 8, y);
+				word &= ~(uint64_t(0xff) << (bit & ~7));
+			}
+		}
+	}
+}
+
+namespace
+{
+	/******************************************************************************/
+	/*!
+	Next state of one cell under any rule, without a branch
+
+	\param rule
+	Rule bits, only read by the kAnyRule instance
+
+	\param sum
+	Live neighbors
+
+	\param cell
+	1 if the cell is alive
+
+	\return
+	1 if the cell is alive next generation
+	*/
+	/******************************************************************************/
+	template <uint32_t kBits>
+	inline uint8_t NextCell(uint32_t rule, int sum, int cell)
+	{
+		return static_cast<uint8_t>((SelectRule<kBits>(rule) >> (sum + 9 * cell)) & 1);
+	}
+
+	/******************************************************************************/
+	/*!
+	Life lives when (neighbors | self) == 3, which covers both 3 neighbors and
+	2 neighbors plus alive
+	*/
+	/******************************************************************************/
+	template <>
+	inline uint8_t NextCell<kLifeBits>(uint32_t, int sum, int cell)
+	{
+		return static_cast<uint8_t>((sum | cell) == 3);
+	}
+
+	/******************************************************************************/
+	/*!
+	Steps a block of cells one at a time
+
+	\param rule
+	Rule bits, only read by the kAnyRule instance
+
+	\param from
+	First cell of the block in the current generation
+
+	\param to
+	First cell of the block in the grid being written
+
+	\param stride
+	Bytes between rows, the same for both grids
+
+	\param width
+	Number of cells in a row of the block
+
+	\param rows
+	Number of rows in the block
+
+	\return
+	If any cell changed
+	*/
+	/******************************************************************************/
+	template <uint32_t kBits>
+	bool StepBlockScalar(uint32_t rule, uint8_t const* from, uint8_t* to, int stride, int width, int rows)
+	{
+		int changed = 0;
+
+		for (int y = 0; y < rows; ++y, from += stride, to += stride)
+		{
+			uint8_t const* up = from - stride;
+			uint8_t const* down = from + stride;
+
+			for (int x = 0; x < width; ++x)
+			{
+				int const sum = up[x - 1] + up[x] + up[x + 1] + from[x - 1] + from[x + 1] + down[x - 1] + down[x] + down[x + 1];
+				to[x] = NextCell<kBits>(rule, sum, from[x]);
+				changed |= to[x] ^ from[x];
+			}
+		}
+
+		return changed != 0;
+	}
+
+#ifdef GOL_X86
+	/******************************************************************************/
+	/*!
+	Next state of 16 cells under any rule, every count the rule names is
+	compared for. With a constant rule the unused counts fold away.
+
+	\param rule
+	Rule bits
+
+	\param sum
+	Live neighbors of each cell
+
+	\param cell
+	1 for each live cell
+
+	\return
+	1 for each cell alive next generation
+	*/
+	/******************************************************************************/
+	__attribute__((target("sse2")))
+	inline __m128i NextCellsSse2(uint32_t rule, __m128i sum, __m128i cell)
+	{
+		__m128i const alive = _mm_cmpeq_epi8(cell, _mm_set1_epi8(1));
+		__m128i next = _mm_setzero_si128();
+
+		for (int n = 0; n <= 8; ++n)
+		{
+			__m128i const born = _mm_set1_epi8(static_cast<char>(0 - ((rule >> n) & 1)));
+			__m128i const stays = _mm_set1_epi8(static_cast<char>(0 - ((rule >> (n + 9)) & 1)));
+			__m128i const count_is = _mm_cmpeq_epi8(sum, _mm_set1_epi8(static_cast<char>(n)));
+			next = _mm_or_si128(next, _mm_and_si128(count_is, _mm_or_si128(_mm_andnot_si128(alive, born), _mm_and_si128(alive, stays))));
+		}
+
+		return _mm_and_si128(next, _mm_set1_epi8(1));
+	}
+
+	/******************************************************************************/
+	/*!
+	Next state of 16 cells, Life keeps its single compare of
+	(neighbors | self) == 3 through the specialization
+	*/
+	/******************************************************************************/
+	template <uint32_t kBits>
+	struct NextCells16
+	{
+		__attribute__((target("sse2")))
+		static __m128i Get(uint32_t rule, __m128i sum, __m128i cell) { return NextCellsSse2(SelectRule<kBits>(rule), sum, cell); }
+	};
+
+	template <>
+	struct NextCells16<kLifeBits>
+	{
+		__attribute__((target("sse2")))
+		static __m128i Get(uint32_t, __m128i sum, __m128i cell)
+		{
+			return _mm_and_si128(_mm_cmpeq_epi8(_mm_or_si128(sum, cell), _mm_set1_epi8(3)), _mm_set1_epi8(1));
+		}
+	};
+
+	/******************************************************************************/
+	/*!
+	Steps a block 16 cells per instruction, width must be a multiple of 16
+
+	\param rule
+	Rule bits, only read by the kAnyRule instance
+
+	\param from
+	First cell of the block in the current generation, 16 byte aligned
+
+	\param to
+	First cell of the block in the grid being written
+
+	\param stride
+	Bytes between rows, the same for both grids
+
+	\param width
+	Number of cells in a row of the block
+
+	\param rows
+	Number of rows in the block
+
+	\return
+	If any cell changed
+	*/
+	/******************************************************************************/
+	template <uint32_t kBits>
+	__attribute__((target("sse2")))
+	bool StepBlockSse2(uint32_t rule, uint8_t const* from, uint8_t* to, int stride, int width, int rows)
+	{
+		__m128i changed = _mm_setzero_si128();
+
+		for (int y = 0; y < rows; ++y, from += stride, to += stride)
+		{
+			uint8_t const* up = from - stride;
+			uint8_t const* down = from + stride;
+
+			for (int x = 0; x < width; x += 16)
+			{
+				__m128i sum = _mm_add_epi8(_mm_loadu_si128(reinterpret_cast<__m128i const*>(up + x - 1)),
+				                           _mm_load_si128(reinterpret_cast<__m128i const*>(up + x)));
+				sum = _mm_add_epi8(sum, _mm_loadu_si128(reinterpret_cast<__m128i const*>(up + x + 1)));
+				sum = _mm_add_epi8(sum, _mm_loadu_si128(reinterpret_cast<__m128i const*>(from + x - 1)));
+				sum = _mm_add_epi8(sum, _mm_loadu_si128(reinterpret_cast<__m128i const*>(from + x + 1)));
+				sum = _mm_add_epi8(sum, _mm_loadu_si128(reinterpret_cast<__m128i const*>(down + x - 1)));
+				sum = _mm_add_epi8(sum, _mm_load_si128(reinterpret_cast<__m128i const*>(down + x)));
+				sum = _mm_add_epi8(sum, _mm_loadu_si128(reinterpret_cast<__m128i const*>(down + x + 1)));
+
+				__m128i const cell = _mm_load_si128(reinterpret_cast<__m128i const*>(from + x));
+				__m128i const next = NextCells16<kBits>::Get(rule, sum, cell);
+				_mm_store_si128(reinterpret_cast<__m128i*>(to + x), next);
+				changed = _mm_or_si128(changed, _mm_xor_si128(next, cell));
+			}
+		}
+
+		return _mm_movemask_epi8(_mm_cmpeq_epi8(changed, _mm_setzero_si128())) != 0xffff;
+	}
+
+	/******************************************************************************/
+	/*!
+	Next state of 32 cells under any rule. The birth and survival counts are
+	two 16 byte tables looked up with one shuffle each, the cell picks which
+	one applies.
+	*/
+	/******************************************************************************/
+	template <uint32_t kBits>
+	struct NextCells32
+	{
+		__attribute__((target("avx2")))
+		static __m256i Get(uint32_t rule, __m256i sum, __m256i cell)
+		{
+			uint32_t const bits = SelectRule<kBits>(rule);
+			__m256i const born = _mm256_shuffle_epi8(Table(bits), sum);
+			__m256i const stays = _mm256_shuffle_epi8(Table(bits >> 9), sum);
+			return _mm256_blendv_epi8(born, stays, _mm256_sub_epi8(_mm256_setzero_si256(), cell));
+		}
+
+		// Byte n of both halves is bit n of counts
+		__attribute__((target("avx2")))
+		static __m256i Table(uint32_t counts)
+		{
+			return _mm256_setr_epi8(
+				counts & 1, (counts >> 1) & 1, (counts >> 2) & 1, (counts >> 3) & 1, (counts >> 4) & 1,
+				(counts >> 5) & 1, (counts >> 6) & 1, (counts >> 7) & 1, (counts >> 8) & 1, 0, 0, 0, 0, 0, 0, 0,
+				counts & 1, (counts >> 1) & 1, (counts >> 2) & 1, (counts >> 3) & 1, (counts >> 4) & 1,
+				(counts >> 5) & 1, (counts >> 6) & 1, (counts >> 7) & 1, (counts >> 8) & 1, 0, 0, 0, 0, 0, 0, 0);
+		}
+	};
+
+	template <>
+	struct NextCells32<kLifeBits>
+	{
+		__attribute__((target("avx2")))
+		static __m256i Get(uint32_t, __m256i sum, __m256i cell)
+		{
+			return _mm256_and_si256(_mm256_cmpeq_epi8(_mm256_or_si256(sum, cell), _mm256_set1_epi8(3)), _mm256_set1_epi8(1));
+		}
+	};
+
+	/******************************************************************************/
+	/*!
+	Steps a block 32 cells per instruction, width must be a multiple of 32
+
+	\param rule
+	Rule bits, only read by the kAnyRule instance
+
+	\param from
+	First cell of the block in the current generation, 32 byte aligned
+
+	\param to
+	First cell of the block in the grid being written
+
+	\param stride
+	Bytes between rows, the same for both grids
+
+	\param width
+	Number of cells in a row of the block
+
+	\param rows
+	Number of rows in the block
+
+	\return
+	If any cell changed
+	*/
+	/******************************************************************************/
+	template <uint32_t kBits>
+	__attribute__((target("avx2")))
+	bool StepBlockAvx2(uint32_t rule, uint8_t const* from, uint8_t* to, int stride, int width, int rows)
+	{
+		__m256i changed = _mm256_setzero_si256();
+
+		for (int y = 0; y < rows; ++y, from += stride, to += stride)
+		{
+			uint8_t const* up = from - stride;
+			uint8_t const* down = from + stride;
+
+			for (int x = 0; x < width; x += 32)
+			{
+				__m256i sum = _mm256_add_epi8(_mm256_loadu_si256(reinterpret_cast<__m256i const*>(up + x - 1)),
+				                              _mm256_load_si256(reinterpret_cast<__m256i const*>(up + x)));
+				sum = _mm256_add_epi8(sum, _mm256_loadu_si256(reinterpret_cast<__m256i const*>(up + x + 1)));
+				sum = _mm256_add_epi8(sum, _mm256_loadu_si256(reinterpret_cast<__m256i const*>(from + x - 1)));
+				sum = _mm256_add_epi8(sum, _mm256_loadu_si256(reinterpret_cast<__m256i const*>(from + x + 1)));
+				sum = _mm256_add_epi8(sum, _mm256_loadu_si256(reinterpret_cast<__m256i const*>(down + x - 1)));
+				sum = _mm256_add_epi8(sum, _mm256_load_si256(reinterpret_cast<__m256i const*>(down + x)));
+				sum = _mm256_add_epi8(sum, _mm256_loadu_si256(reinterpret_cast<__m256i const*>(down + x + 1)));
+
+				__m256i const cell = _mm256_load_si256(reinterpret_cast<__m256i const*>(from + x));
+				__m256i const next = NextCells32<kBits>::Get(rule, sum, cell);
+				_mm256_store_si256(reinterpret_cast<__m256i*>(to + x), next);
+				changed = _mm256_or_si256(changed, _mm256_xor_si256(next, cell));
+			}
+		}
+
+		return !_mm256_testz_si256(changed, changed);
+	}
+#endif
+
+	// Instruction sets a block kernel can be compiled for
+	enum class Isa
+	{
+		kScalar,
+		kSse2,
+		kAvx2
+	};
+
+	struct Kernel
+	{
+		Isa isa;
+		char const* name;
+	};
+
+	/******************************************************************************/
+	/*!
+	Picks the widest kernel the cpu supports
+
+	\return
+	Kernel to use for every block
+	*/
+	/******************************************************************************/
+	Kernel PickKernel()
+	{
+		Kernel result = { Isa::kScalar, "scalar" };
+
+#ifdef GOL_X86
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx2"))
+		{
+			result.isa = Isa::kAvx2;
+			result.name = "avx2";
+		}
+		else if (__builtin_cpu_supports("sse2"))
+		{
+			result.isa = Isa::kSse2;
+			result.name = "sse2";
+		}
+#endif
+
+		return result;
+	}
+
+	Kernel const kernel = PickKernel();
+
+	/******************************************************************************/
+	/*!
+	Widest kernel for the cpu, compiled once per rule, see DispatchRule
+	*/
+	/******************************************************************************/
+	template <uint32_t kBits>
+	struct BlockKernel
+	{
+		static bool Run(uint32_t rule, uint8_t const* from, uint8_t* to, int stride, int width, int rows)
+		{
+			switch (kernel.isa)
+			{
+#ifdef GOL_X86
+			case Isa::kAvx2:
+				return StepBlockAvx2<kBits>(rule, from, to, stride, width, rows);
+			case Isa::kSse2:
+				return StepBlockSse2<kBits>(rule, from, to, stride, width, rows);
+#endif
+			default:
+				return StepBlockScalar<kBits>(rule, from, to, stride, width, rows);
+			}
+		}
+	};
+
+	/******************************************************************************/
+	/*!
+	Scalar kernel for the ragged ends of a rectangle, compiled once per rule
+	*/
+	/******************************************************************************/
+	template <uint32_t kBits>
+	struct ScalarKernel
+	{
+		static bool Run(uint32_t rule, uint8_t const* from, uint8_t* to, int stride, int width, int rows)
+		{
+			return StepBlockScalar<kBits>(rule, from, to, stride, width, rows);
+		}
+	};
+}
+
+/******************************************************************************/
+/*!
+Steps a band of rows from one grid into another
+
+\param from
+Grid in the current generation
+
+\param to
+Grid that receives the next generation, same size as from
+
+\param y0
+First row to step
+
+\param y1
+One past the last row to step
+
+\param rule
+Rule to step with
+*/
+/******************************************************************************/
+void StepGridRows(ByteGrid const& from, ByteGrid* to, int y0, int y1, Rule const& rule)
+{
+	int const width = from.Width();
+	if (y0 >= y1)
+	{
+		return;
+	}
+
+	DispatchRule<BlockKernel>(RuleBits(rule), from.Row(y0), to->Row(y0), from.Stride(), width, y1 - y0);
+
+	//Vector kernels also step the padding past the right edge, it must stay dead
+	int const padding = (width + ByteGrid::kPad - 1) / ByteGrid::kPad * ByteGrid::kPad - width;
+	for (int y = y0; y < y1; ++y)
+	{
+		std::memset(to->Row(y) + width, 0, padding);
+	}
+}
+
+/******************************************************************************/
+/*!
+Steps a rectangle of cells from one grid into another without touching any
+cell outside of it, so workers can own tiles that share rows. Whole 32 cell
+chunks inside the rectangle use the vector kernel, the ragged ends are
+stepped one cell at a time.
+
+\param from
+Grid in the current generation
+
+\param to
+Grid that receives the next generation, same size as from
+
+\param x0, x1
+First column and one past the last column to step
+
+\param y0, y1
+First row and one past the last row to step
+
+\param rule
+Rule to step with
+
+\return
+If any cell of the rectangle changed
+*/
+/******************************************************************************/
+bool StepGridRect(ByteGrid const& from, ByteGrid* to, int x0, int x1, int y0, int y1, Rule const& rule)
+{
+	int const kChunk = ByteGrid::kPad;
+
+	//Chunk aligned middle part of the rectangle
+	int a = (x0 + kChunk - 1) / kChunk * kChunk;
+	int b = x1 / kChunk * kChunk;
+	if (a > b)
+	{
+		a = b = x1;
+	}
+
+	if (y0 >= y1)
+	{
+		return false;
+	}
+
+	uint8_t const* in = from.Row(y0);
+	uint8_t* out = to->Row(y0);
+	int const stride = from.Stride();
+	int const rows = y1 - y0;
+	uint32_t const bits = RuleBits(rule);
+
+	bool changed = false;
+	if (a > x0)
+	{
+		changed |= DispatchRule<ScalarKernel>(bits, in + x0, out + x0, stride, a - x0, rows);
+	}
+	if (b > a)
+	{
+		changed |= DispatchRule<BlockKernel>(bits, in + a, out + a, stride, b - a, rows);
+	}
+	if (x1 > b)
+	{
+		changed |= DispatchRule<ScalarKernel>(bits, in + b, out + b, stride, x1 - b, rows);
+	}
+
+	return changed;
+}
+
+/******************************************************************************/
+/*!
+Name of the kernel picked for this cpu
+
+\return
+"avx2", "sse2" or "scalar"
+*/
+/******************************************************************************/
+char const* GridKernelName()
+{
+	return kernel.name;
+}
+
+/******************************************************************************/
+/*!
+Hashes the cells of the grid 8 at a time, the padding is skipped
+
+\param grid
+Grid to hash
+
+\return
+Hash of the cells
+*/
+/******************************************************************************/
+uint64_t HashBoard(ByteGrid const& grid)
+{
+	int const width = grid.Width();
+	uint64_t hash = 0;
+
+	for (int y = 0; y < grid.Height(); ++y)
+	{
+		uint8_t const* row = grid.Row(y);
+
+		int x = 0;
+		for (; x + 8 <= width; x += 8)
+		{
+			uint64_t word;
+			std::memcpy(&word, row + x, sizeof(word));
+			hash = HashWord(hash, word);
+		}
+		for (; x < width; ++x)
+		{
+			hash = HashWord(hash, row[x]);
+		}
+	}
+
+	return hash;
+}
+
+namespace
+{
+	/******************************************************************************/
+	/*!
+	Two byte grids that are swapped every generation, each worker owns a band
+	of rows and steps it with the vector kernel
+	*/
+	/******************************************************************************/
+	class SimdSimulation : public Simulation
+	{
+	public:
+		SimdSimulation(BoardView const& initial, Options const& options);
+
+		void Advance(int generations);
+		std::vector< std::tuple<int, int> > Result() const;
+		uint64_t Hash() const { return HashBoard(grids_[current_]); }
+		bool Alive(int x, int y) const { return grids_[current_].Row(y)[x] != 0; }
+		void ForEachLive(std::function<void(int, int)> const& visit) const { ::ForEachLive(grids_[current_], visit); }
+		void GetStats(Stats* stats) const { CountBandPages(grids_, bands_, pool_, stats); }
+
+	private:
+		void Step(int worker, int generations);
+
+		ByteGrid grids_[2];
+		int current_;
+		Rule rule_;
+		Boundary boundary_;
+		std::vector<Tile> bands_;
+		WorkerPool pool_;
+		Barrier barrier_;
+	};
+
+	/******************************************************************************/
+	/*!
+	Creates both grids and splits the rows into one band per worker
+
+	\param initial
+	Board to start from
+
+	\param options
+	Thread count, rule and boundary to use
+	*/
+	/******************************************************************************/
+	SimdSimulation::SimdSimulation(BoardView const& initial, Options const& options)
+		: Simulation(initial.Width(), initial.Height()),
+		  current_(0),
+		  rule_(options.rule),
+		  boundary_(options.boundary),
+		  bands_(SplitBands(initial.Width(), initial.Height(), options.num_threads > 0 ? options.num_threads : WorkerPool::DefaultSize())),
+		  pool_(static_cast<int>(bands_.size()), options.numa),
+		  barrier_(static_cast<int>(bands_.size()), options.barrier)
+	{
+		grids_[0] = CreateByteGrid(initial);
+		grids_[1] = ByteGrid(initial.Width(), initial.Height());
+		if (boundary_ == Boundary::kWrap)
+		{
+			WrapBorder(&grids_[0], 0, initial.Width(), 0, initial.Height());
+		}
+		if (options.numa && !bands_.empty())
+		{
+			PlaceBands(grids_, initial.Height(), bands_, &pool_);
+		}
+		tracer_.Start(pool_.Size());
+	}
+
+	/******************************************************************************/
+	/*!
+	Steps the grid on every worker
+
+	\param generations
+	Number of generations to step
+	*/
+	/******************************************************************************/
+	void SimdSimulation::Advance(int generations)
+	{
+		if (generations <= 0 || bands_.empty())
+		{
+			return;
+		}
+
+		pool_.Run([this, generations](int worker) { Step(worker, generations); });
+
+		current_ = (current_ + generations) % 2;
+	}
+
+	/******************************************************************************/
+	/*!
+	Main logic for one worker, one barrier per generation
+
+	\param worker
+	Index of the worker and of the band it owns
+
+	\param generations
+	Number of generations to step
+	*/
+	/******************************************************************************/
+	void SimdSimulation::Step(int worker, int generations)
+	{
+		Tile const band = bands_[worker];
+		int current = current_;
+
+		for (int i = 0; i < generations; ++i)
+		{
+			{
+				GOL_TRACE_PHASE(&tracer_, worker, Phase::kCompute, i);
+				StepGridRows(grids_[current], &grids_[1 - current], band.y0, band.y1, rule_);
+				if (boundary_ == Boundary::kWrap)
+				{
+					WrapBorder(&grids_[1 - current], band.x0, band.x1, band.y0, band.y1);
+				}
+			}
+			current = 1 - current;
+
+			{
+				GOL_TRACE_PHASE(&tracer_, worker, Phase::kBarrier, i);
+				barrier_.Wait(worker);
+			}
+		}
+	}
+
+	/******************************************************************************/
+	/*!
+	Gets coordinates of all live spaces on board
+
+	\return
+	All coordinates of live spaces on board
+	*/
+	/******************************************************************************/
+	std::vector< std::tuple<int, int> > SimdSimulation::Result() const
+	{
+		return GetResult(grids_[current_]);
+	}
+}
+
+/******************************************************************************/
+/*!
+Creates the vectorized byte grid engine
+
+\param initial
+Board to start from
+
+\param options
+Thread count to use
+
+\return
+Newly allocated simulation, owned by the caller
+*/
+/******************************************************************************/
+Simulation* CreateSimdSimulation(BoardView const& initial, Options const& options)
+{
+	return new SimdSimulation(initial, options);
+}
@@ -0,0 +1,79 @@
+/******************************************************************************/
+/*!
+\file   grid.h
+\author Isaac Hill
+\par    email: Isaac.Hill@digipen.edu
+\par    DigiPen login: Isaac.Hill
+\par    Course: CS355
+\par    Assignment #1
+\date   1/21/2020
+\brief
+This is the Header file for the flat byte per cell game of life board and the
+vectorized kernels that step it
+*/
+/******************************************************************************/
+
+#ifndef GRID_H
+#define GRID_H
+
+#include "gol.h"
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include <tuple>
+
+/******************************************************************************/
+/*!
+Row major board with one byte per cell, 0 dead and 1 alive. The buffer is
+cache line aligned, cell 0 of every row sits on a 32 byte boundary and every
+row has 32 dead bytes on both sides, so a kernel can load 32 cells starting
+one to the left or right of any chunk without checking for the edge. There
+is a dead row above and below the board.
+*/
+/******************************************************************************/
+class ByteGrid
+{
+public:
+	static int const kPad = 32;
+	static int const kAlign = 64;
+
+	ByteGrid();
+	ByteGrid(int width, int height);
+	ByteGrid(ByteGrid const& rhs);
+	ByteGrid(ByteGrid&& rhs);
+	~ByteGrid();
+
+	ByteGrid& operator=(ByteGrid rhs);
+
+	int Width() const { return width_; }
+	int Height() const { return height_; }
+	int Stride() const { return stride_; }
+
+	uint8_t* Row(int y) { return data_ + (y + 1) * stride_ + kPad; }
+	uint8_t const* Row(int y) const { return data_ + (y + 1) * stride_ + kPad; }
+
+	// Start of row y with its padding, -1 and height are the border rows and
+	// height + 1 is the end of the grid
+	uint8_t* Line(int y) { return data_ + (y + 1) * stride_; }
+	uint8_t const* Line(int y) const { return data_ + (y + 1) * stride_; }
+
+private:
+	int width_;
+	int height_;
+	int stride_;
+	uint8_t* data_;
+};
+
+ByteGrid CreateByteGrid(BoardView const& initial);
+void StepGridRows(ByteGrid const& from, ByteGrid* to, int y0, int y1, Rule const& rule);
+bool StepGridRect(ByteGrid const& from, ByteGrid* to, int x0, int x1, int y0, int y1, Rule const& rule);
+void WrapBorder(ByteGrid* grid, int x0, int x1, int y0, int y1);
+std::vector< std::tuple<int, int> > GetResult(ByteGrid const& grid);
+void ForEachLive(ByteGrid const& grid, std::function<void(int, int)> const& visit);
+uint64_t HashBoard(ByteGrid const& grid);
+
+// Name of the kernel picked for this cpu, "avx2", "sse2" or "scalar"
+char const* GridKernelName();
+
+#endif
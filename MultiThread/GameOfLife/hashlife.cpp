@@ -0,0 +1,737 @@
+/******************************************************************************/
+/*!
+\file   hashlife.cpp
+\author Isaac Hill
+\par    email: Isaac.Hill@digipen.edu
+\par    DigiPen login: Isaac.Hill
+\par    Course: CS355
+\par    Assignment #1
+\date   1/21/2020
+\brief
+This is the Implementation file for the HashLife engine
+
+Operations include:
+-Constructor
+-Advance
+-Result
+-Step
+-CollectGarbage
+*/
+/******************************************************************************/
+
+#include "hashlife.h"
+#include "simulation.h"
+
+#include <algorithm>
+
+HashLife::NodeId const HashLife::kDead;
+HashLife::NodeId const HashLife::kAlive;
+HashLife::NodeId const HashLife::kWall;
+HashLife::NodeId const HashLife::kNone;
+
+/******************************************************************************/
+/*!
+Mixes the four children of a node into one hash
+
+\param key
+Children of the node
+
+\return
+Hash of the key
+*/
+/******************************************************************************/
+size_t HashLife::KeyHash::operator()(Key const& key) const
+{
+	uint64_t h = key.nw;
+	h = h * 0x9e3779b97f4a7c15ULL + key.ne;
+	h = h * 0x9e3779b97f4a7c15ULL + key.sw;
+	h = h * 0x9e3779b97f4a7c15ULL + key.se;
+	return static_cast<size_t>(h ^ (h >> 29));
+}
+
+/******************************************************************************/
+/*!
+Builds the quadtree for the board
+
+\param initial
+Board to start from
+
+\param cache_bytes
+Memory the node cache may use before it is garbage collected
+
+\param rule
+Rule to step with, the memoized results only hold for this rule
+*/
+/******************************************************************************/
+HashLife::HashLife(BoardView const& initial, size_t cache_bytes, Rule const& rule)
+	: width_(initial.Width()), height_(initial.Height()), root_(kDead), level_(2), base_level_(2),
+	  origin_x_(0), origin_y_(0), cache_bytes_(cache_bytes), leaves_(rule)
+{
+	//Leaves, a level 0 node is a single cell
+	Node leaf = { kNone, kNone, kNone, kNone, kNone, 0, 0 };
+	nodes_.push_back(leaf);
+	leaf.population = 1;
+	nodes_.push_back(leaf);
+	leaf.population = 0;
+	nodes_.push_back(leaf);
+
+	while ((1 << level_) < width_ || (1 << level_) < height_)
+	{
+		++level_;
+	}
+	base_level_ = level_;
+
+	std::vector< std::tuple<int, int> > cells;
+	initial.ForEachLive([&cells](int x, int y) { cells.push_back(std::make_tuple(x, y)); });
+
+	root_ = Build(cells, 0, 0, level_);
+}
+
+/******************************************************************************/
+/*!
+Canonical node with the given children
+
+\return
+Id of the existing node if there is one, otherwise of a new one
+*/
+/******************************************************************************/
+HashLife::NodeId HashLife::Join(NodeId nw, NodeId ne, NodeId sw, NodeId se)
+{
+	Key const key = { nw, ne, sw, se };
+	std::unordered_map<Key, NodeId, KeyHash>::const_iterator it = table_.find(key);
+	if (it != table_.end())
+	{
+		return it->second;
+	}
+
+	Node node;
+	node.nw = nw;
+	node.ne = ne;
+	node.sw = sw;
+	node.se = se;
+	node.result = kNone;
+	node.level = nodes_[nw].level + 1;
+	node.population = nodes_[nw].population + nodes_[ne].population + nodes_[sw].population + nodes_[se].population;
+
+	NodeId const id = static_cast<NodeId>(nodes_.size());
+	nodes_.push_back(node);
+	table_.insert(std::make_pair(key, id));
+
+	return id;
+}
+
+/******************************************************************************/
+/*!
+Node of the given level with every cell dead
+
+\param level
+Level of the node
+
+\return
+Id of the node
+*/
+/******************************************************************************/
+HashLife::NodeId HashLife::Dead(int level)
+{
+	if (level == 0)
+	{
+		return kDead;
+	}
+
+	while (static_cast<int>(dead_.size()) <= level)
+	{
+		dead_.push_back(kNone);
+	}
+
+	if (dead_[level] == kNone)
+	{
+		NodeId const child = Dead(level - 1);
+		dead_[level] = Join(child, child, child, child);
+	}
+
+	return dead_[level];
+}
+
+/******************************************************************************/
+/*!
+Node of the given level that lies entirely outside of the board
+
+\param level
+Level of the node
+
+\return
+Id of the node
+*/
+/******************************************************************************/
+HashLife::NodeId HashLife::Wall(int level)
+{
+	if (level == 0)
+	{
+		return kWall;
+	}
+
+	while (static_cast<int>(wall_.size()) <= level)
+	{
+		wall_.push_back(kNone);
+	}
+
+	if (wall_[level] == kNone)
+	{
+		NodeId const child = Wall(level - 1);
+		wall_[level] = Join(child, child, child, child);
+	}
+
+	return wall_[level];
+}
+
+/******************************************************************************/
+/*!
+Builds the node covering a square of the board
+
+\param cells
+Live cells inside the square
+
+\param x0
+Left column of the square
+
+\param y0
+Top row of the square
+
+\param level
+Square is 2^level cells on a side
+
+\return
+Id of the node
+*/
+/******************************************************************************/
+HashLife::NodeId HashLife::Build(std::vector< std::tuple<int, int> > const& cells, int x0, int y0, int level)
+{
+	int const size = 1 << level;
+
+	if (x0 >= width_ || y0 >= height_)
+	{
+		return Wall(level);
+	}
+
+	bool const inside = x0 + size <= width_ && y0 + size <= height_;
+	if (cells.empty() && inside)
+	{
+		return Dead(level);
+	}
+
+	if (level == 0)
+	{
+		return cells.empty() ? kDead : kAlive;
+	}
+
+	//Split the cells between the four quadrants
+	int const half = size / 2;
+	std::vector< std::tuple<int, int> > quadrants[4];
+	for (unsigned i = 0; i < cells.size(); ++i)
+	{
+		int const x = std::get<0>(cells[i]);
+		int const y = std::get<1>(cells[i]);
+		quadrants[(x >= x0 + half ? 1 : 0) + (y >= y0 + half ? 2 : 0)].push_back(cells[i]);
+	}
+
+	NodeId const nw = Build(quadrants[0], x0, y0, level - 1);
+	NodeId const ne = Build(quadrants[1], x0 + half, y0, level - 1);
+	NodeId const sw = Build(quadrants[2], x0, y0 + half, level - 1);
+	NodeId const se = Build(quadrants[3], x0 + half, y0 + half, level - 1);
+
+	return Join(nw, ne, sw, se);
+}
+
+/******************************************************************************/
+/*!
+Center half of a node without stepping it
+
+\param id
+Node of level 2 or more
+
+\return
+Id of the center node, one level down
+*/
+/******************************************************************************/
+HashLife::NodeId HashLife::Center(NodeId id)
+{
+	Node const node = nodes_[id];
+	return Join(nodes_[node.nw].se, nodes_[node.ne].sw, nodes_[node.sw].ne, nodes_[node.se].nw);
+}
+
+/******************************************************************************/
+/*!
+Steps the center 2x2 of a 4x4 node one generation with one table lookup.
+Wall cells count as dead neighbors and stay wall.
+
+\param id
+Node of level 2
+
+\return
+Id of the level 1 result
+*/
+/******************************************************************************/
+HashLife::NodeId HashLife::StepLeaf(NodeId id)
+{
+	Node const node = nodes_[id];
+	NodeId const quadrants[4] = { node.nw, node.ne, node.sw, node.se };
+
+	//Unpack into a 4x4 grid indexed [y][x]
+	NodeId cells[4][4];
+	for (int q = 0; q < 4; ++q)
+	{
+		Node const& child = nodes_[quadrants[q]];
+		int const x = (q % 2) * 2;
+		int const y = (q / 2) * 2;
+		cells[y][x] = child.nw;
+		cells[y][x + 1] = child.ne;
+		cells[y + 1][x] = child.sw;
+		cells[y + 1][x + 1] = child.se;
+	}
+
+	unsigned window = 0;
+	for (int y = 0; y < 4; ++y)
+	{
+		for (int x = 0; x < 4; ++x)
+		{
+			window |= (cells[y][x] == kAlive ? 1u : 0u) << (x + 4 * y);
+		}
+	}
+	unsigned const next = leaves_.Next(window);
+
+	NodeId result[4];
+	for (int i = 0; i < 4; ++i)
+	{
+		int const x = 1 + i % 2;
+		int const y = 1 + i / 2;
+		result[i] = cells[y][x] == kWall ? kWall : ((next >> i) & 1 ? kAlive : kDead);
+	}
+
+	return Join(result[0], result[1], result[2], result[3]);
+}
+
+/******************************************************************************/
+/*!
+Center half of a node after 2^j generations, memoized
+
+\param id
+Node of level k, k >= 2
+
+\param j
+Log2 of the generations to step, at most k - 2
+
+\return
+Id of the level k - 1 result
+*/
+/******************************************************************************/
+HashLife::NodeId HashLife::Step(NodeId id, int j)
+{
+	Node const node = nodes_[id];
+	int const k = node.level;
+	bool const full = j == k - 2;
+	uint64_t const partial_key = (static_cast<uint64_t>(id) << 8) | static_cast<uint64_t>(j);
+
+	if (full && node.result != kNone)
+	{
+		return node.result;
+	}
+	if (!full)
+	{
+		std::unordered_map<uint64_t, NodeId>::const_iterator it = partial_.find(partial_key);
+		if (it != partial_.end())
+		{
+			return it->second;
+		}
+	}
+
+	NodeId result;
+
+	if (node.population == 0)
+	{
+		//Nothing alive, dead and wall cells never change
+		result = Center(id);
+	}
+	else if (k == 2)
+	{
+		result = StepLeaf(id);
+	}
+	else
+	{
+		//Grandchildren as a 4x4 grid indexed [y][x]
+		NodeId const children[4] = { node.nw, node.ne, node.sw, node.se };
+		NodeId g[4][4];
+		for (int q = 0; q < 4; ++q)
+		{
+			Node const& child = nodes_[children[q]];
+			int const x = (q % 2) * 2;
+			int const y = (q / 2) * 2;
+			g[y][x] = child.nw;
+			g[y][x + 1] = child.ne;
+			g[y + 1][x] = child.sw;
+			g[y + 1][x + 1] = child.se;
+		}
+
+		//Nine overlapping level k - 1 nodes, stepped half way on a full step
+		NodeId r[3][3];
+		for (int y = 0; y < 3; ++y)
+		{
+			for (int x = 0; x < 3; ++x)
+			{
+				NodeId const m = Join(g[y][x], g[y][x + 1], g[y + 1][x], g[y + 1][x + 1]);
+				r[y][x] = full ? Step(m, k - 3) : Center(m);
+			}
+		}
+
+		//Four level k - 1 nodes around the quadrants of the center, stepped the rest
+		NodeId q[4];
+		for (int i = 0; i < 4; ++i)
+		{
+			int const x = i % 2;
+			int const y = i / 2;
+			NodeId const m = Join(r[y][x], r[y][x + 1], r[y + 1][x], r[y + 1][x + 1]);
+			q[i] = Step(m, full ? k - 3 : j);
+		}
+
+		result = Join(q[0], q[1], q[2], q[3]);
+	}
+
+	if (full)
+	{
+		nodes_[id].result = result;
+	}
+	else
+	{
+		partial_.insert(std::make_pair(partial_key, result));
+	}
+
+	return result;
+}
+
+/******************************************************************************/
+/*!
+Doubles the root, the old root becomes the center and the rest is wall
+*/
+/******************************************************************************/
+void HashLife::Expand()
+{
+	Node const root = nodes_[root_];
+	NodeId const w = Wall(level_ - 1);
+
+	NodeId const nw = Join(w, w, w, root.nw);
+	NodeId const ne = Join(w, w, root.ne, w);
+	NodeId const sw = Join(w, root.sw, w, w);
+	NodeId const se = Join(root.se, w, w, w);
+
+	root_ = Join(nw, ne, sw, se);
+	origin_x_ -= int64_t(1) << (level_ - 1);
+	origin_y_ -= int64_t(1) << (level_ - 1);
+	++level_;
+}
+
+/******************************************************************************/
+/*!
+Halves the root for as long as everything outside its center is wall
+*/
+/******************************************************************************/
+void HashLife::Shrink()
+{
+	while (level_ > base_level_)
+	{
+		Node const root = nodes_[root_];
+		NodeId const w = Wall(level_ - 2);
+		Node const& nw = nodes_[root.nw];
+		Node const& ne = nodes_[root.ne];
+		Node const& sw = nodes_[root.sw];
+		Node const& se = nodes_[root.se];
+
+		if (nw.nw != w || nw.ne != w || nw.sw != w ||
+		    ne.nw != w || ne.ne != w || ne.se != w ||
+		    sw.nw != w || sw.sw != w || sw.se != w ||
+		    se.ne != w || se.sw != w || se.se != w)
+		{
+			break;
+		}
+
+		root_ = Center(root_);
+		origin_x_ += int64_t(1) << (level_ - 2);
+		origin_y_ += int64_t(1) << (level_ - 2);
+		--level_;
+	}
+}
+
+/******************************************************************************/
+/*!
+Steps the whole board 2^j generations
+
+\param j
+Log2 of the generations to step
+*/
+/******************************************************************************/
+void HashLife::StepRoot(int j)
+{
+	//The board has to sit inside the center of the root for its result to cover it
+	while (level_ < j + 1)
+	{
+		Expand();
+	}
+	Expand();
+
+	root_ = Step(root_, j);
+	origin_x_ += int64_t(1) << (level_ - 2);
+	origin_y_ += int64_t(1) << (level_ - 2);
+	--level_;
+
+	Shrink();
+
+	if (MemoryUsage() > cache_bytes_)
+	{
+		CollectGarbage();
+	}
+}
+
+/******************************************************************************/
+/*!
+Steps the board, one power of two jump per set bit of generations
+
+\param generations
+Number of generations to step
+*/
+/******************************************************************************/
+void HashLife::Advance(int generations)
+{
+	for (int j = 0; generations > 0; ++j, generations >>= 1)
+	{
+		if (generations & 1)
+		{
+			StepRoot(j);
+		}
+	}
+}
+
+/******************************************************************************/
+/*!
+Adds the live cells under a node to the result
+
+\param id
+Node to collect
+
+\param x0
+Left column of the node
+
+\param y0
+Top row of the node
+
+\param result
+Receives the live cells
+*/
+/******************************************************************************/
+void HashLife::Collect(NodeId id, int64_t x0, int64_t y0, std::vector< std::tuple<int, int> >* result) const
+{
+	Node const& node = nodes_[id];
+	if (node.population == 0)
+	{
+		return;
+	}
+
+	if (node.level == 0)
+	{
+		result->push_back(std::make_tuple(static_cast<int>(x0), static_cast<int>(y0)));
+		return;
+	}
+
+	int64_t const half = int64_t(1) << (node.level - 1);
+	Collect(node.nw, x0, y0, result);
+	Collect(node.ne, x0 + half, y0, result);
+	Collect(node.sw, x0, y0 + half, result);
+	Collect(node.se, x0 + half, y0 + half, result);
+}
+
+/******************************************************************************/
+/*!
+Gets coordinates of all live spaces on board, in the same order as the
+nested vector version
+
+\return
+All coordinates of live spaces on board
+*/
+/******************************************************************************/
+std::vector< std::tuple<int, int> > HashLife::Result() const
+{
+	std::vector< std::tuple<int, int> > result;
+	Collect(root_, origin_x_, origin_y_, &result);
+	std::sort(result.begin(), result.end());
+
+	return result;
+}
+
+/******************************************************************************/
+/*!
+Looks up one cell by walking down from the root
+
+\param x, y
+Cell to look at, in board coordinates
+
+\return
+If the cell is alive
+*/
+/******************************************************************************/
+bool HashLife::Alive(int x, int y) const
+{
+	int64_t const dx = x - origin_x_;
+	int64_t const dy = y - origin_y_;
+
+	NodeId id = root_;
+	while (nodes_[id].level > 0 && nodes_[id].population > 0)
+	{
+		Node const& node = nodes_[id];
+		int const bit = node.level - 1;
+		bool const east = (dx >> bit) & 1;
+		bool const south = (dy >> bit) & 1;
+		id = south ? (east ? node.se : node.sw) : (east ? node.ne : node.nw);
+	}
+
+	return id == kAlive;
+}
+
+/******************************************************************************/
+/*!
+Rough number of bytes held by the node cache
+
+\return
+Bytes used by nodes, the canonical table and the memoized results
+*/
+/******************************************************************************/
+size_t HashLife::MemoryUsage() const
+{
+	//Each hash map entry is a heap node holding the pair and a next pointer
+	size_t const table_entry = sizeof(Key) + sizeof(NodeId) + 2 * sizeof(void*);
+	size_t const partial_entry = sizeof(uint64_t) + sizeof(NodeId) + 2 * sizeof(void*);
+
+	return nodes_.capacity() * sizeof(Node) +
+	       table_.size() * table_entry + table_.bucket_count() * sizeof(void*) +
+	       partial_.size() * partial_entry + partial_.bucket_count() * sizeof(void*);
+}
+
+/******************************************************************************/
+/*!
+Copies a node and everything under it into a new node list
+
+\param id
+Node to copy
+
+\param nodes
+New node list
+
+\param moved
+New id of every old node, kNone when it has not been copied yet
+
+\return
+New id of the node
+*/
+/******************************************************************************/
+HashLife::NodeId HashLife::Copy(NodeId id, std::vector<Node>* nodes, std::vector<NodeId>* moved)
+{
+	if ((*moved)[id] != kNone)
+	{
+		return (*moved)[id];
+	}
+
+	Node node = nodes_[id];
+	node.nw = Copy(node.nw, nodes, moved);
+	node.ne = Copy(node.ne, nodes, moved);
+	node.sw = Copy(node.sw, nodes, moved);
+	node.se = Copy(node.se, nodes, moved);
+	node.result = kNone;
+
+	NodeId const new_id = static_cast<NodeId>(nodes->size());
+	nodes->push_back(node);
+	(*moved)[id] = new_id;
+
+	return new_id;
+}
+
+/******************************************************************************/
+/*!
+Throws away every node the root does not use, along with all memoized
+results. Only runs between jumps, a single jump may go over the cap.
+*/
+/******************************************************************************/
+void HashLife::CollectGarbage()
+{
+	std::vector<Node> nodes;
+	std::vector<NodeId> moved(nodes_.size(), kNone);
+
+	//Leaves keep their ids
+	for (NodeId i = kDead; i <= kWall; ++i)
+	{
+		nodes.push_back(nodes_[i]);
+		moved[i] = i;
+	}
+
+	root_ = Copy(root_, &nodes, &moved);
+
+	nodes_.swap(nodes);
+	std::vector<Node>(nodes_).swap(nodes_);
+
+	std::unordered_map<Key, NodeId, KeyHash>().swap(table_);
+	std::unordered_map<uint64_t, NodeId>().swap(partial_);
+	for (NodeId i = kWall + 1; i < nodes_.size(); ++i)
+	{
+		Node const& node = nodes_[i];
+		Key const key = { node.nw, node.ne, node.sw, node.se };
+		table_.insert(std::make_pair(key, i));
+	}
+
+	dead_.clear();
+	wall_.clear();
+}
+
+namespace
+{
+	/******************************************************************************/
+	/*!
+	Runs HashLife behind the same interface as the pooled engines
+	*/
+	/******************************************************************************/
+	class HashLifeSimulation : public Simulation
+	{
+	public:
+		HashLifeSimulation(BoardView const& initial, Options const& options)
+			: Simulation(initial.Width(), initial.Height()),
+			  universe_(initial, options.hashlife_cache_bytes, options.rule)
+		{
+		}
+
+		void Advance(int generations) { universe_.Advance(generations); }
+		std::vector< std::tuple<int, int> > Result() const { return universe_.Result(); }
+		bool Alive(int x, int y) const { return universe_.Alive(x, y); }
+
+	private:
+		HashLife universe_;
+	};
+}
+
+/******************************************************************************/
+/*!
+Creates the HashLife engine
+
+\param initial
+Board to start from
+
+\param options
+Node cache cap to use
+
+\return
+Newly allocated simulation, owned by the caller
+*/
+/******************************************************************************/
+Simulation* CreateHashLifeSimulation(BoardView const& initial, Options const& options)
+{
+	//The quadtree grows into the plane around the board, it has no edges to join
+	if (options.boundary == Boundary::kWrap)
+	{
+		throw "HashLife cannot wrap the board";
+	}
+
+	return new HashLifeSimulation(initial, options);
+}
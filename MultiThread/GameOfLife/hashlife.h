@@ -0,0 +1,106 @@
+/******************************************************************************/
+/*!
+\file   hashlife.h
+\author Isaac Hill
+\par    email: Isaac.Hill@digipen.edu
+\par    DigiPen login: Isaac.Hill
+\par    Course: CS355
+\par    Assignment #1
+\date   1/21/2020
+\brief
+This is the Header file for the HashLife engine, a memoized quadtree that can
+skip ahead an exponential number of generations at once
+*/
+/******************************************************************************/
+
+#ifndef HASHLIFE_H
+#define HASHLIFE_H
+
+#include "gol.h"
+#include "lookup.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include <tuple>
+
+/******************************************************************************/
+/*!
+Quadtree universe with canonical nodes. Cells outside the board are a third
+"wall" state that is always dead and never changes, so a node still fully
+decides its own future and results can be memoized while the board keeps the
+same dead border semantics as the other engines.
+*/
+/******************************************************************************/
+class HashLife
+{
+public:
+	HashLife(BoardView const& initial, size_t cache_bytes, Rule const& rule);
+
+	void Advance(int generations);
+	std::vector< std::tuple<int, int> > Result() const;
+	bool Alive(int x, int y) const;
+
+	size_t MemoryUsage() const;
+	size_t NodeCount() const { return nodes_.size(); }
+
+private:
+	typedef uint32_t NodeId;
+
+	static NodeId const kDead = 0;
+	static NodeId const kAlive = 1;
+	static NodeId const kWall = 2;
+	static NodeId const kNone = 0xffffffff;
+
+	struct Node
+	{
+		NodeId nw, ne, sw, se;
+		NodeId result;      // center after 2^(level-2) generations, kNone until stepped
+		int level;
+		uint64_t population;
+	};
+
+	struct Key
+	{
+		NodeId nw, ne, sw, se;
+		bool operator==(Key const& rhs) const { return nw == rhs.nw && ne == rhs.ne && sw == rhs.sw && se == rhs.se; }
+	};
+
+	struct KeyHash
+	{
+		size_t operator()(Key const& key) const;
+	};
+
+	NodeId Join(NodeId nw, NodeId ne, NodeId sw, NodeId se);
+	NodeId Dead(int level);
+	NodeId Wall(int level);
+	NodeId Build(std::vector< std::tuple<int, int> > const& cells, int x0, int y0, int level);
+	void StepRoot(int j);
+	NodeId Center(NodeId id);
+	NodeId Step(NodeId id, int j);
+	NodeId StepLeaf(NodeId id);
+	void Expand();
+	void Shrink();
+	void Collect(NodeId id, int64_t x0, int64_t y0, std::vector< std::tuple<int, int> >* result) const;
+	void CollectGarbage();
+	NodeId Copy(NodeId id, std::vector<Node>* nodes, std::vector<NodeId>* moved);
+
+	std::vector<Node> nodes_;
+	std::unordered_map<Key, NodeId, KeyHash> table_;
+	std::unordered_map<uint64_t, NodeId> partial_; // results of steps shorter than a full one
+	std::vector<NodeId> dead_;
+	std::vector<NodeId> wall_;
+
+	int width_;
+	int height_;
+	NodeId root_;
+	int level_;
+	int base_level_;
+	int64_t origin_x_; // top left cell of the root, in board coordinates
+	int64_t origin_y_;
+	size_t cache_bytes_;
+	BlockTable leaves_; // steps the 4x4 nodes
+};
+
+#endif
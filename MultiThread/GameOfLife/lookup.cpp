@@ -0,0 +1,169 @@
+/******************************************************************************/
+/*!
+\file   lookup.cpp
+\author Isaac Hill
+\par    email: Isaac.Hill@digipen.edu
+\par    DigiPen login: Isaac.Hill
+\par    Course: CS355
+\par    Assignment #1
+\date   1/21/2020
+\brief
+This is the Implementation file for the block lookup table and the engine
+that steps a bit packed board 2x2 cells at a time through it. It needs no
+vector instructions, only shifts and one table load per block.
+*/
+/******************************************************************************/
+
+#include "lookup.h"
+#include "simulation.h"
+
+#include <memory>
+
+/******************************************************************************/
+/*!
+Fills the table by stepping every one of the 65536 windows once, which takes
+about a millisecond
+
+\param rule
+Rule the table follows
+*/
+/******************************************************************************/
+BlockTable::BlockTable(Rule const& rule) : entries_(1 << 15, 0)
+{
+	uint32_t const bits = RuleBits(rule);
+
+	for (unsigned window = 0; window < (1u << 16); ++window)
+	{
+		unsigned result = 0;
+		for (int i = 0; i < 4; ++i)
+		{
+			int const x = 1 + i % 2;
+			int const y = 1 + i / 2;
+
+			int count = 0;
+			for (int dy = -1; dy <= 1; ++dy)
+			{
+				for (int dx = -1; dx <= 1; ++dx)
+				{
+					if (dx != 0 || dy != 0)
+					{
+						count += (window >> (x + dx + 4 * (y + dy))) & 1;
+					}
+				}
+			}
+
+			unsigned const self = (window >> (x + 4 * y)) & 1;
+			result |= ((bits >> (count + 9 * self)) & 1) << i;
+		}
+
+		entries_[window >> 1] = static_cast<uint8_t>(entries_[window >> 1] | (result << ((window & 1) * 4)));
+	}
+}
+
+/******************************************************************************/
+/*!
+Steps a band of rows two at a time. For every pair of rows the four rows
+around it are read a word at a time and each 2x2 block of the pair looks up
+its 4x4 window. A band with an odd number of rows ends with a pair whose
+second row is left alone.
+
+\param from
+Board in the current generation
+
+\param to
+Board that receives the next generation, same size as from
+
+\param y0
+First row to step
+
+\param y1
+One past the last row to step
+
+\param table
+Table of the rule to step with
+*/
+/******************************************************************************/
+void StepRows(BitBoard const& from, BitBoard* to, int y0, int y1, BlockTable const& table)
+{
+	int const words = from.words;
+	if (words == 0)
+	{
+		return;
+	}
+
+	uint64_t const tail_mask = from.TailMask();
+
+	for (int y = y0; y < y1; y += 2)
+	{
+		bool const pair = y + 1 < y1;
+		uint64_t const* rows[4] = { from.Row(y - 1), from.Row(y), from.Row(y + 1), pair ? from.Row(y + 2) : from.Row(y + 1) };
+
+		for (int w = 0; w < words; ++w)
+		{
+			//Bit i of window is cell 64 * w + i - 1, so block k reads bits 2k to 2k + 3.
+			//The last block runs one bit into ext, the window of the next word.
+			uint64_t window[4];
+			uint64_t ext[4];
+			for (int r = 0; r < 4; ++r)
+			{
+				window[r] = (rows[r][w] << 1) | (rows[r][w - 1] >> 63);
+				ext[r] = (rows[r][w + 1] << 1) | (rows[r][w] >> 63);
+			}
+
+			uint64_t top = 0;
+			uint64_t bottom = 0;
+			for (int k = 0; k < 31; ++k)
+			{
+				unsigned const index = static_cast<unsigned>(((window[0] >> (2 * k)) & 0xf) |
+				                                             (((window[1] >> (2 * k)) & 0xf) << 4) |
+				                                             (((window[2] >> (2 * k)) & 0xf) << 8) |
+				                                             (((window[3] >> (2 * k)) & 0xf) << 12));
+				uint64_t const next = table.Next(index);
+				top |= (next & 3) << (2 * k);
+				bottom |= (next >> 2) << (2 * k);
+			}
+
+			unsigned const index = static_cast<unsigned>((((window[0] >> 62) | (ext[0] << 2)) & 0xf) |
+			                                             ((((window[1] >> 62) | (ext[1] << 2)) & 0xf) << 4) |
+			                                             ((((window[2] >> 62) | (ext[2] << 2)) & 0xf) << 8) |
+			                                             ((((window[3] >> 62) | (ext[3] << 2)) & 0xf) << 12));
+			uint64_t const next = table.Next(index);
+			top |= (next & 3) << 62;
+			bottom |= (next >> 2) << 62;
+
+			//Cells past the right edge must stay dead
+			uint64_t const mask = w + 1 < words ? ~uint64_t(0) : tail_mask;
+			to->Row(y)[w] = top & mask;
+			if (pair)
+			{
+				to->Row(y + 1)[w] = bottom & mask;
+			}
+		}
+	}
+}
+
+/******************************************************************************/
+/*!
+Creates the block lookup table engine, the banded bit packed engine with
+its rows stepped through the table
+
+\param initial
+Board to start from
+
+\param options
+Thread count, rule and boundary to use
+
+\return
+Newly allocated simulation, owned by the caller
+*/
+/******************************************************************************/
+Simulation* CreateLookupSimulation(BoardView const& initial, Options const& options)
+{
+	//Shared by every copy of the kernel, built once
+	std::shared_ptr<BlockTable const> const table(new BlockTable(options.rule));
+
+	return CreateBitSimulation(initial, options, [table](BitBoard const& from, BitBoard* to, int y0, int y1)
+	{
+		StepRows(from, to, y0, y1, *table);
+	});
+}
@@ -0,0 +1,46 @@
+/******************************************************************************/
+/*!
+\file   lookup.h
+\author Isaac Hill
+\par    email: Isaac.Hill@digipen.edu
+\par    DigiPen login: Isaac.Hill
+\par    Course: CS355
+\par    Assignment #1
+\date   1/21/2020
+\brief
+This is the Header file for the block lookup table, which gives the next
+state of the middle 2x2 cells of any 4x4 window in one load
+*/
+/******************************************************************************/
+
+#ifndef LOOKUP_H
+#define LOOKUP_H
+
+#include "gol.h"
+#include "bitboard.h"
+
+#include <cstdint>
+#include <vector>
+
+/******************************************************************************/
+/*!
+Next generation of every 4x4 window under one rule. Bit x + 4 * y of a
+window is cell (x, y) of it, bit x + 2 * y of the result is cell
+(x + 1, y + 1) in the next generation. Two results share a byte so the
+whole table is 32 KB and stays in the L1 cache.
+*/
+/******************************************************************************/
+class BlockTable
+{
+public:
+	explicit BlockTable(Rule const& rule);
+
+	unsigned Next(unsigned window) const { return (entries_[window >> 1] >> ((window & 1) * 4)) & 0xf; }
+
+private:
+	std::vector<uint8_t> entries_;
+};
+
+void StepRows(BitBoard const& from, BitBoard* to, int y0, int y1, BlockTable const& table);
+
+#endif
@@ -0,0 +1,241 @@
+/******************************************************************************/
+/*!
+\file   numa.cpp
+\author Isaac Hill
+\par    email: Isaac.Hill@digipen.edu
+\par    DigiPen login: Isaac.Hill
+\par    Course: CS355
+\par    Assignment #1
+\date   1/21/2020
+\brief
+This is the Implementation file for finding the NUMA nodes, releasing pages
+so they are placed again and asking the kernel where pages live. The nodes
+come from sysfs and the rest are plain system calls, so no NUMA library is
+needed. Elsewhere every core is on node 0 and pages are left alone.
+*/
+/******************************************************************************/
+
+#include "numa.h"
+
+#include <cstdio>
+#include <cstdint>
+
+#ifdef __linux__
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+	int const kMaxNodes = 1024; // node directories looked for in sysfs
+
+	/******************************************************************************/
+	/*!
+	Reads a list of cores written as "0-3,8,10-11"
+
+	\param file
+	File holding the list
+
+	\return
+	Every core in the list, empty if the file could not be read
+	*/
+	/******************************************************************************/
+	std::vector<int> ReadCpuList(char const* file)
+	{
+		std::vector<int> result;
+
+		FILE* in = std::fopen(file, "r");
+		if (!in)
+		{
+			return result;
+		}
+
+		int first;
+		while (std::fscanf(in, "%d", &first) == 1)
+		{
+			int last = first;
+			int c = std::fgetc(in);
+			if (c == '-')
+			{
+				if (std::fscanf(in, "%d", &last) != 1)
+				{
+					break;
+				}
+				c = std::fgetc(in);
+			}
+
+			for (int cpu = first; cpu <= last; ++cpu)
+			{
+				result.push_back(cpu);
+			}
+
+			if (c != ',')
+			{
+				break;
+			}
+		}
+
+		std::fclose(in);
+		return result;
+	}
+
+	/******************************************************************************/
+	/*!
+	Size of a page
+
+	\return
+	Bytes in a page
+	*/
+	/******************************************************************************/
+	size_t PageSize()
+	{
+#ifdef __linux__
+		return static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#else
+		return 4096;
+#endif
+	}
+}
+
+/******************************************************************************/
+/*!
+Lists the cores this process may run on, node 0 first. Without sysfs every
+allowed core is put on node 0.
+
+\return
+Cores grouped by node, in increasing order inside a node
+*/
+/******************************************************************************/
+std::vector<Cpu> CpusByNode()
+{
+	std::vector<Cpu> result;
+
+#ifdef __linux__
+	cpu_set_t allowed;
+	CPU_ZERO(&allowed);
+	if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0)
+	{
+		return result;
+	}
+
+	for (int node = 0; node < kMaxNodes; ++node)
+	{
+		char file[64];
+		std::snprintf(file, sizeof(file), "/sys/devices/system/node/node%d/cpulist", node);
+
+		std::vector<int> const cpus = ReadCpuList(file);
+		for (unsigned i = 0; i < cpus.size(); ++i)
+		{
+			if (cpus[i] < CPU_SETSIZE && CPU_ISSET(cpus[i], &allowed))
+			{
+				Cpu const cpu = { cpus[i], node };
+				result.push_back(cpu);
+			}
+		}
+	}
+
+	if (result.empty())
+	{
+		for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+		{
+			if (CPU_ISSET(cpu, &allowed))
+			{
+				Cpu const entry = { cpu, 0 };
+				result.push_back(entry);
+			}
+		}
+	}
+#endif
+
+	return result;
+}
+
+/******************************************************************************/
+/*!
+Drops the whole pages inside a buffer, the partial pages at either end are
+left where they are
+
+\param data
+Start of the buffer
+
+\param bytes
+Size of the buffer
+*/
+/******************************************************************************/
+void ReleasePages(void* data, size_t bytes)
+{
+#ifdef __linux__
+	uintptr_t const page = PageSize();
+	uintptr_t const begin = (reinterpret_cast<uintptr_t>(data) + page - 1) / page * page;
+	uintptr_t const end = (reinterpret_cast<uintptr_t>(data) + bytes) / page * page;
+	if (begin < end)
+	{
+		madvise(reinterpret_cast<void*>(begin), end - begin, MADV_DONTNEED);
+	}
+#else
+	(void)data;
+	(void)bytes;
+#endif
+}
+
+/******************************************************************************/
+/*!
+Asks the kernel which node every page of a buffer is on, the partial pages
+at either end count too
+
+\param data
+Start of the buffer
+
+\param bytes
+Size of the buffer
+
+\param node
+Node that counts as local
+
+\param local
+Incremented for every page on node
+
+\param remote
+Incremented for every page on another node
+*/
+/******************************************************************************/
+void CountPages(void const* data, size_t bytes, int node, long long* local, long long* remote)
+{
+	if (bytes == 0)
+	{
+		return;
+	}
+
+	uintptr_t const page = PageSize();
+	uintptr_t const begin = reinterpret_cast<uintptr_t>(data) / page * page;
+	uintptr_t const end = reinterpret_cast<uintptr_t>(data) + bytes;
+
+	std::vector<void*> pages;
+	for (uintptr_t p = begin; p < end; p += page)
+	{
+		pages.push_back(reinterpret_cast<void*>(p));
+	}
+
+	std::vector<int> nodes(pages.size(), node);
+#ifdef __linux__
+	//With no target nodes move_pages only reports where each page is
+	if (syscall(SYS_move_pages, 0, pages.size(), &pages[0], 0, &nodes[0], 0) != 0)
+	{
+		return;
+	}
+#endif
+
+	for (unsigned i = 0; i < nodes.size(); ++i)
+	{
+		if (nodes[i] == node)
+		{
+			++*local;
+		}
+		else if (nodes[i] >= 0)
+		{
+			++*remote;
+		}
+	}
+}
@@ -0,0 +1,128 @@
+/******************************************************************************/
+/*!
+\file   numa.h
+\author Isaac Hill
+\par    email: Isaac.Hill@digipen.edu
+\par    DigiPen login: Isaac.Hill
+\par    Course: CS355
+\par    Assignment #1
+\date   1/21/2020
+\brief
+This is the Header file for placing the banded engines on a NUMA machine.
+Workers are pinned to cores in node order, the pages of each band are
+first touched by the worker that steps it and the pages each worker reads
+can be counted by the node they live on.
+*/
+/******************************************************************************/
+
+#ifndef NUMA_H
+#define NUMA_H
+
+#include "gol.h"
+#include "simulation.h"
+#include "pool.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+// Core a worker can be pinned to and the node it belongs to
+struct Cpu
+{
+	int id;
+	int node;
+};
+
+// Cores this process may run on, grouped by node so neighboring workers share one
+std::vector<Cpu> CpusByNode();
+
+// Hands the whole pages of a buffer back to the kernel, what they held is lost
+// and the next write to each places it on the node of the thread that writes
+void ReleasePages(void* data, size_t bytes);
+
+// Adds the pages of a buffer to local if they are on node and to remote if not,
+// pages that were never touched are not counted
+void CountPages(void const* data, size_t bytes, int node, long long* local, long long* remote);
+
+/******************************************************************************/
+/*!
+Moves the pages of a pair of boards to the workers that step them. Every
+page is released and each worker writes its band of both boards back, the
+first board from a copy and the second as dead cells, so the first touch of
+every page inside a band comes from its owner. The first and last band also
+take the border rows. Board is a BitBoard or a ByteGrid, anything with
+Line(y) for the start of the memory of row y.
+
+\param boards
+The two boards, the first holds the initial cells
+
+\param height
+Rows of the boards
+
+\param bands
+Rows each worker owns, top to bottom
+
+\param pool
+Workers, one per band
+*/
+/******************************************************************************/
+template <typename Board>
+void PlaceBands(Board* boards, int height, std::vector<Tile> const& bands, WorkerPool* pool)
+{
+	Board const start = boards[0];
+	for (int b = 0; b < 2; ++b)
+	{
+		ReleasePages(boards[b].Line(-1), (boards[b].Line(height + 1) - boards[b].Line(-1)) * sizeof(*boards[b].Line(-1)));
+	}
+
+	pool->Run([&](int worker)
+	{
+		int const y0 = bands[worker].y0 == 0 ? -1 : bands[worker].y0;
+		int const y1 = bands[worker].y1 == height ? height + 1 : bands[worker].y1;
+
+		std::copy(start.Line(y0), start.Line(y1), boards[0].Line(y0));
+		std::fill(boards[1].Line(y0), boards[1].Line(y1), 0);
+	});
+}
+
+/******************************************************************************/
+/*!
+Counts the pages every worker reads in a generation, its band and the halo
+rows above and below it in both boards, by whether they are on the node the
+worker is pinned to. Once the bands are placed only the halo rows should be
+remote.
+
+\param boards
+The two boards
+
+\param bands
+Rows each worker owns
+
+\param pool
+Workers, one per band, nothing is counted unless they are pinned
+
+\param stats
+Receives the counts in local_pages and remote_pages
+*/
+/******************************************************************************/
+template <typename Board>
+void CountBandPages(Board const* boards, std::vector<Tile> const& bands, WorkerPool const& pool, Stats* stats)
+{
+	for (int worker = 0; worker < pool.Size(); ++worker)
+	{
+		int const node = pool.Node(worker);
+		if (node < 0)
+		{
+			continue;
+		}
+
+		for (int b = 0; b < 2; ++b)
+		{
+			auto const begin = boards[b].Line(bands[worker].y0 - 1);
+			auto const end = boards[b].Line(bands[worker].y1 + 1);
+			CountPages(begin, (end - begin) * sizeof(*begin), node, &stats->local_pages, &stats->remote_pages);
+		}
+	}
+}
+
+#endif
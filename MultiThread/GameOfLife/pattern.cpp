@@ -0,0 +1,1060 @@
+/******************************************************************************/
+/*!
+\file   pattern.cpp
+\author Isaac Hill
+\par    email: Isaac.Hill@digipen.edu
+\par    DigiPen login: Isaac.Hill
+\par    Course: CS355
+\par    Assignment #1
+\date   1/21/2020
+\brief
+This is the Implementation file for the pattern loaders. Files are mapped
+into memory and parsed in place, cells go straight into the bit packed board.
+
+The binary bitmap format (.golb) is a 16 byte header, the characters "GOLB",
+then the width, the height and a zero word as little endian 32 bit numbers.
+The rows follow, each one (width + 63) / 64 little endian 64 bit words with
+bit x % 64 of word x / 64 holding cell x.
+*/
+/******************************************************************************/
+
+#include "pattern.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+	uint32_t const kBitmapMagic = 0x424c4f47; // "GOLB" read as a little endian word
+	size_t const kBitmapHeader = 16;
+
+	/******************************************************************************/
+	/*!
+	Read only memory mapping of a whole file, unmapped when it goes out of scope
+	*/
+	/******************************************************************************/
+	class MappedFile
+	{
+	public:
+		explicit MappedFile(char const* path);
+		~MappedFile();
+
+		char const* Begin() const { return data_; }
+		char const* End() const { return data_ + size_; }
+		size_t Size() const { return size_; }
+
+	private:
+		MappedFile(MappedFile const&);
+		MappedFile& operator=(MappedFile const&);
+
+		char const* data_;
+		size_t size_;
+	};
+
+	/******************************************************************************/
+	/*!
+	Maps a file
+
+	\param path
+	File to map
+	*/
+	/******************************************************************************/
+	MappedFile::MappedFile(char const* path) : data_(0), size_(0)
+	{
+		int const fd = open(path, O_RDONLY);
+		if (fd < 0)
+		{
+			throw "cannot open pattern file";
+		}
+
+		struct stat info;
+		if (fstat(fd, &info) != 0)
+		{
+			close(fd);
+			throw "cannot read pattern file";
+		}
+
+		size_ = static_cast<size_t>(info.st_size);
+		if (size_ > 0)
+		{
+			void* data = mmap(0, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (data == MAP_FAILED)
+			{
+				close(fd);
+				throw "cannot map pattern file";
+			}
+
+			//Patterns are read front to back once
+			madvise(data, size_, MADV_SEQUENTIAL);
+			data_ = static_cast<char const*>(data);
+		}
+
+		//The mapping stays valid without the descriptor
+		close(fd);
+	}
+
+	/******************************************************************************/
+	/*!
+	Unmaps the file
+	*/
+	/******************************************************************************/
+	MappedFile::~MappedFile()
+	{
+		if (data_)
+		{
+			munmap(const_cast<char*>(data_), size_);
+		}
+	}
+
+	/******************************************************************************/
+	/*!
+	Reads a little endian 32 bit number
+
+	\param p
+	First byte
+
+	\return
+	The number
+	*/
+	/******************************************************************************/
+	uint32_t ReadWord32(char const* p)
+	{
+		unsigned char const* b = reinterpret_cast<unsigned char const*>(p);
+		return b[0] | (b[1] << 8) | (b[2] << 16) | (static_cast<uint32_t>(b[3]) << 24);
+	}
+
+	/******************************************************************************/
+	/*!
+	Adds a decimal digit to the end of a number
+
+	\param number
+	Number so far, not negative
+
+	\param digit
+	Character '0' to '9'
+
+	\return
+	number * 10 + digit
+
+	\exception const char*
+	If the result does not fit an int
+	*/
+	/******************************************************************************/
+	int AppendDigit(int number, char digit)
+	{
+		int const d = digit - '0';
+		if (number > (INT_MAX - d) / 10)
+		{
+			throw "pattern has a number too large for a board";
+		}
+		return number * 10 + d;
+	}
+
+	/******************************************************************************/
+	/*!
+	Skips white space and reads a non negative number
+
+	\param p
+	Read position, moved past the number
+
+	\param end
+	End of the text
+
+	\param value
+	Receives the number
+
+	\return
+	False if there was no number before the end or the next non space character
+
+	\exception const char*
+	If the number does not fit an int
+	*/
+	/******************************************************************************/
+	bool ReadNumber(char const** p, char const* end, int* value)
+	{
+		char const* c = *p;
+		while (c != end && (*c == ' ' || *c == '\t' || *c == '\r' || *c == '\n'))
+		{
+			++c;
+		}
+
+		if (c == end || *c < '0' || *c > '9')
+		{
+			*p = c;
+			return false;
+		}
+
+		int result = 0;
+		while (c != end && *c >= '0' && *c <= '9')
+		{
+			result = AppendDigit(result, *c);
+			++c;
+		}
+
+		*value = result;
+		*p = c;
+		return true;
+	}
+
+	/******************************************************************************/
+	/*!
+	Finds the number after "name =" in an RLE header line
+
+	\param line, end
+	The header line
+
+	\param name
+	'x' or 'y'
+
+	\param value
+	Receives the number
+
+	\return
+	If the header has the field
+	*/
+	/******************************************************************************/
+	bool ReadHeaderField(char const* line, char const* end, char name, int* value)
+	{
+		for (char const* c = line; c != end; ++c)
+		{
+			//A field name starts the line or follows a comma
+			if (*c != name || (c != line && c[-1] != ',' && c[-1] != ' '))
+			{
+				continue;
+			}
+
+			char const* p = c + 1;
+			while (p != end && *p == ' ')
+			{
+				++p;
+			}
+
+			if (p != end && *p == '=')
+			{
+				++p;
+				return ReadNumber(&p, end, value);
+			}
+		}
+
+		return false;
+	}
+
+	/******************************************************************************/
+	/*!
+	Checks the end of a path
+
+	\param path
+	Path to check
+
+	\param extension
+	Extension including the dot
+
+	\return
+	If path ends with extension
+	*/
+	/******************************************************************************/
+	bool HasExtension(char const* path, char const* extension)
+	{
+		size_t const length = std::strlen(path);
+		size_t const size = std::strlen(extension);
+		return length >= size && std::strcmp(path + length - size, extension) == 0;
+	}
+
+	/******************************************************************************/
+	/*!
+	Orders cells row by row, then from the left
+
+	\param a, b
+	(x, y) of the cells
+
+	\return
+	If a comes before b
+	*/
+	/******************************************************************************/
+	bool RowMajor(std::tuple<int, int> const& a, std::tuple<int, int> const& b)
+	{
+		return std::get<1>(a) < std::get<1>(b) || (std::get<1>(a) == std::get<1>(b) && std::get<0>(a) < std::get<0>(b));
+	}
+
+	/******************************************************************************/
+	/*!
+	Finds the next cell in a state along a row, a word at a time
+
+	\param row
+	Bit packed row
+
+	\param width
+	Cells in the row, the bits past it are dead
+
+	\param x
+	First cell to look at
+
+	\param alive
+	State to look for
+
+	\return
+	The first cell from x on in that state, width if there is none
+	*/
+	/******************************************************************************/
+	int NextCell(uint64_t const* row, int width, int x, bool alive)
+	{
+		int const words = (width + 63) / 64;
+		int w = x / 64;
+		if (w >= words)
+		{
+			return width;
+		}
+
+		uint64_t bits = (alive ? row[w] : ~row[w]) & (~uint64_t(0) << (x % 64));
+		while (bits == 0)
+		{
+			if (++w == words)
+			{
+				return width;
+			}
+			bits = alive ? row[w] : ~row[w];
+		}
+
+		int const result = w * 64 + __builtin_ctzll(bits);
+		return result < width ? result : width;
+	}
+
+	/******************************************************************************/
+	/*!
+	Adds one run to an RLE body, a run never straddles two lines and no line
+	is longer than 70 characters
+
+	\param out
+	Body so far
+
+	\param line
+	Characters on the current line of the body
+
+	\param count
+	Length of the run, 1 is written without a count
+
+	\param tag
+	b, o, $ or !
+	*/
+	/******************************************************************************/
+	void PutRun(std::string* out, int* line, int count, char tag)
+	{
+		char text[16];
+		int const size = count > 1 ? std::snprintf(text, sizeof(text), "%d%c", count, tag) : std::snprintf(text, sizeof(text), "%c", tag);
+
+		if (*line + size > 70)
+		{
+			*out += '\n';
+			*line = 0;
+		}
+
+		out->append(text, size);
+		*line += size;
+	}
+
+	/******************************************************************************/
+	/*!
+	Starts the text of an RLE file
+
+	\param board
+	Board whose size goes in the header
+
+	\param comments
+	Text of the #C lines to write above the header
+
+	\return
+	The comment lines and the header line
+	*/
+	/******************************************************************************/
+	std::string RleHeader(BoardView const& board, std::vector<std::string> const& comments)
+	{
+		std::string out;
+		for (unsigned i = 0; i < comments.size(); ++i)
+		{
+			out += "#C " + comments[i] + "\n";
+		}
+		out += "x = " + std::to_string(board.Width()) + ", y = " + std::to_string(board.Height()) + "\n";
+		return out;
+	}
+
+	/******************************************************************************/
+	/*!
+	Writes the whole text of an RLE file at once
+
+	\param out
+	Text of the file
+
+	\param path
+	File to write
+	*/
+	/******************************************************************************/
+	void WriteRle(std::string const& out, char const* path)
+	{
+		std::FILE* file = std::fopen(path, "wb");
+		if (!file)
+		{
+			throw "cannot create RLE file";
+		}
+
+		bool const ok = std::fwrite(out.data(), 1, out.size(), file) == out.size();
+		if (std::fclose(file) != 0 || !ok)
+		{
+			throw "cannot write RLE file";
+		}
+	}
+
+	/******************************************************************************/
+	/*!
+	Reads the comment lines and the header line of an RLE pattern
+
+	\param position
+	Read position, moved to the start of the body
+
+	\param end
+	End of the text
+
+	\param comments
+	Optional, receives the text after "#C" of every comment line before the header
+
+	\param width, height
+	Receive the size in the header
+
+	\exception const char*
+	If there is no header
+	*/
+	/******************************************************************************/
+	void ReadRleHeader(char const** position, char const* end, std::vector<std::string>* comments, int* width, int* height)
+	{
+		char const* p = *position;
+
+		//Skip comments up to the header line
+		*width = -1;
+		*height = -1;
+		while (p != end)
+		{
+			char const* eol = static_cast<char const*>(std::memchr(p, '\n', end - p));
+			if (!eol)
+			{
+				eol = end;
+			}
+
+			char const* line = p;
+			p = eol == end ? end : eol + 1;
+
+			while (line != eol && (*line == ' ' || *line == '\t'))
+			{
+				++line;
+			}
+
+			if (line == eol || *line == '#' || *line == '\r')
+			{
+				if (comments && eol - line >= 2 && line[0] == '#' && (line[1] == 'C' || line[1] == 'c'))
+				{
+					char const* text = line + 2;
+					char const* text_end = eol;
+					while (text != text_end && *text == ' ')
+					{
+						++text;
+					}
+					while (text_end != text && (text_end[-1] == '\r' || text_end[-1] == ' '))
+					{
+						--text_end;
+					}
+					comments->push_back(std::string(text, text_end));
+				}
+				continue;
+			}
+
+			if (!ReadHeaderField(line, eol, 'x', width) || !ReadHeaderField(line, eol, 'y', height))
+			{
+				throw "RLE pattern has no x = , y = header";
+			}
+			break;
+		}
+
+		if (*width < 0 || *height < 0)
+		{
+			throw "RLE pattern has no x = , y = header";
+		}
+
+		*position = p;
+	}
+
+	/******************************************************************************/
+	/*!
+	Parses a run length encoded pattern into a board, see LoadRle
+
+	\param path
+	File to load
+
+	\param comments
+	Optional, receives the text after "#C" of every comment line before the header
+
+	\return
+	The pattern, a Pattern or a CellList
+	*/
+	/******************************************************************************/
+	template <class Board>
+	Board ReadRle(char const* path, std::vector<std::string>* comments)
+	{
+		MappedFile const file(path);
+		char const* p = file.Begin();
+		char const* const end = file.End();
+
+		int width, height;
+		ReadRleHeader(&p, end, comments, &width, &height);
+
+		Board result(width, height);
+
+		int x = 0, y = 0;
+		int count = 0;
+		for (; p != end; ++p)
+		{
+			char const c = *p;
+			if (c >= '0' && c <= '9')
+			{
+				count = AppendDigit(count, c);
+				continue;
+			}
+
+			int const run = count > 0 ? count : 1;
+			count = 0;
+
+			if (c == '!')
+			{
+				break;
+			}
+			else if (c == '$')
+			{
+				//Runs past the edge stop at it, a live cell there is refused below
+				y = run > height - y ? height : y + run;
+				x = 0;
+			}
+			else if (c == 'b' || c == '.')
+			{
+				x = run > width - x ? width : x + run;
+			}
+			else if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'))
+			{
+				if (run > width - x || y >= height)
+				{
+					throw "RLE pattern does not fit the size in its header";
+				}
+
+				for (int i = 0; i < run; ++i)
+				{
+					result.Set(x++, y);
+				}
+			}
+		}
+
+		return result;
+	}
+
+	/******************************************************************************/
+	/*!
+	Parses a pattern in the driver's text format into a board, see LoadText
+
+	\param path
+	File to load
+
+	\return
+	The pattern, a Pattern or a CellList
+	*/
+	/******************************************************************************/
+	template <class Board>
+	Board ReadText(char const* path)
+	{
+		MappedFile const file(path);
+		char const* p = file.Begin();
+		char const* const end = file.End();
+
+		int width = 0, height = 0;
+		if (!ReadNumber(&p, end, &width) || !ReadNumber(&p, end, &height))
+		{
+			throw "text pattern has no board size";
+		}
+
+		Board result(width, height);
+
+		int x, y;
+		while (ReadNumber(&p, end, &x) && ReadNumber(&p, end, &y))
+		{
+			if (x >= width || y >= height)
+			{
+				throw "text pattern has a cell outside the board";
+			}
+
+			result.Set(x, y);
+		}
+
+		return result;
+	}
+}
+
+/******************************************************************************/
+/*!
+Checks a bit packed board of the given size would fit in the physical memory
+of the host, so a huge size is refused with a message instead of aborting
+the allocation or paging the host to a halt
+
+\param width
+Cells in a row
+
+\param height
+Number of rows
+
+\return
+If the board fits
+*/
+/******************************************************************************/
+bool FitsBitPacked(int width, int height)
+{
+	if (width <= 0 || height <= 0)
+	{
+		return true;
+	}
+
+	uint64_t const bytes = (static_cast<uint64_t>(width) + 63) / 64 * sizeof(uint64_t) * static_cast<uint64_t>(height);
+	long const pages = sysconf(_SC_PHYS_PAGES);
+	long const page_size = sysconf(_SC_PAGESIZE);
+	if (pages <= 0 || page_size <= 0)
+	{
+		return true;
+	}
+
+	return bytes / static_cast<uint64_t>(page_size) < static_cast<uint64_t>(pages);
+}
+
+/******************************************************************************/
+/*!
+Creates an empty pattern
+
+\param width
+Cells in a row
+
+\param height
+Number of rows
+
+\exception const char*
+If the board does not fit in memory, see FitsBitPacked
+*/
+/******************************************************************************/
+Pattern::Pattern(int width, int height)
+	: BoardView(width, height), words_((width + 63) / 64)
+{
+	if (!FitsBitPacked(width, height))
+	{
+		throw "board is too large to hold bit packed";
+	}
+
+	cells_.assign(static_cast<size_t>(words_) * height, 0);
+}
+
+/******************************************************************************/
+/*!
+Visits every live cell row by row, a whole word of dead cells at a time
+
+\param visit
+Called with the coordinates of each live cell
+*/
+/******************************************************************************/
+void Pattern::ForEachLive(std::function<void(int, int)> const& visit) const
+{
+	for (int y = 0; y < Height(); ++y)
+	{
+		uint64_t const* row = Row(y);
+		for (int w = 0; w < words_; ++w)
+		{
+			uint64_t word = row[w];
+			while (word)
+			{
+				visit(w * 64 + __builtin_ctzll(word), y);
+				word &= word - 1;
+			}
+		}
+	}
+}
+
+/******************************************************************************/
+/*!
+Puts the cells in row major order and drops any set twice, for cells that
+were not set in that order
+*/
+/******************************************************************************/
+void CellList::Sort()
+{
+	std::sort(cells_.begin(), cells_.end(), RowMajor);
+	cells_.erase(std::unique(cells_.begin(), cells_.end()), cells_.end());
+}
+
+/******************************************************************************/
+/*!
+Looks a cell up with a binary search of the list
+
+\param x, y
+Cell to look up
+
+\return
+If the cell is live
+*/
+/******************************************************************************/
+bool CellList::Alive(int x, int y) const
+{
+	std::tuple<int, int> const cell(x, y);
+	return std::binary_search(cells_.begin(), cells_.end(), cell, RowMajor);
+}
+
+/******************************************************************************/
+/*!
+Visits every live cell in row major order
+
+\param visit
+Called with the coordinates of each live cell
+*/
+/******************************************************************************/
+void CellList::ForEachLive(std::function<void(int, int)> const& visit) const
+{
+	for (unsigned i = 0; i < cells_.size(); ++i)
+	{
+		visit(std::get<0>(cells_[i]), std::get<1>(cells_[i]));
+	}
+}
+
+/******************************************************************************/
+/*!
+Loads a pattern in the standard run length encoded format. Lines starting
+with # are comments, the header gives the size as "x = width, y = height"
+and the rule is ignored. In the body b is a dead cell, o or any other letter
+a live one, $ ends a row and ! ends the pattern, each optionally preceded by
+a repeat count.
+
+\param path
+File to load
+
+\param comments
+Optional, receives the text after "#C" of every comment line before the header
+
+\return
+The pattern
+*/
+/******************************************************************************/
+Pattern LoadRle(char const* path, std::vector<std::string>* comments)
+{
+	return ReadRle<Pattern>(path, comments);
+}
+
+/******************************************************************************/
+/*!
+Loads a pattern in the binary bitmap format, each row is one copy
+
+\param path
+File to load
+
+\return
+The pattern
+*/
+/******************************************************************************/
+Pattern LoadBitmap(char const* path)
+{
+	MappedFile const file(path);
+
+	if (file.Size() < kBitmapHeader || ReadWord32(file.Begin()) != kBitmapMagic)
+	{
+		throw "not a binary bitmap pattern";
+	}
+
+	uint32_t const width = ReadWord32(file.Begin() + 4);
+	uint32_t const height = ReadWord32(file.Begin() + 8);
+	if (width > 0x7fffffff || height > 0x7fffffff)
+	{
+		throw "binary bitmap pattern is too large";
+	}
+
+	//Check the rows are all there before allocating for a header that may lie
+	size_t const row_bytes = (static_cast<size_t>(width) + 63) / 64 * sizeof(uint64_t);
+	if (row_bytes && (file.Size() - kBitmapHeader) / row_bytes < height)
+	{
+		throw "binary bitmap pattern is cut short";
+	}
+
+	Pattern result(static_cast<int>(width), static_cast<int>(height));
+
+	char const* rows = file.Begin() + kBitmapHeader;
+	for (int y = 0; y < result.Height(); ++y)
+	{
+		std::memcpy(result.Row(y), rows + row_bytes * y, row_bytes);
+	}
+
+	//Bits past the width would be live cells outside the board
+	if (width % 64)
+	{
+		uint64_t const mask = (uint64_t(1) << (width % 64)) - 1;
+		for (int y = 0; y < result.Height(); ++y)
+		{
+			result.Row(y)[result.Words() - 1] &= mask;
+		}
+	}
+
+	return result;
+}
+
+/******************************************************************************/
+/*!
+Loads a pattern in the driver's text format, the board size followed by the
+x y coordinates of every live cell
+
+\param path
+File to load
+
+\return
+The pattern
+*/
+/******************************************************************************/
+Pattern LoadText(char const* path)
+{
+	return ReadText<Pattern>(path);
+}
+
+/******************************************************************************/
+/*!
+Loads a pattern in the run length encoded format as a list of its live cells,
+see LoadRle
+
+\param path
+File to load
+
+\param comments
+Optional, receives the text after "#C" of every comment line before the header
+
+\return
+The live cells in row major order
+*/
+/******************************************************************************/
+CellList LoadRleCells(char const* path, std::vector<std::string>* comments)
+{
+	return ReadRle<CellList>(path, comments);
+}
+
+/******************************************************************************/
+/*!
+Reads only the size in the header of an RLE pattern, the body is not parsed
+
+\param path
+File to read
+
+\param width, height
+Receive the size of the board
+*/
+/******************************************************************************/
+void LoadRleSize(char const* path, int* width, int* height)
+{
+	MappedFile const file(path);
+	char const* p = file.Begin();
+	ReadRleHeader(&p, file.End(), 0, width, height);
+}
+
+/******************************************************************************/
+/*!
+Loads a pattern in the driver's text format as a list of its live cells, the
+cells may come in any order
+
+\param path
+File to load
+
+\return
+The live cells in row major order
+*/
+/******************************************************************************/
+CellList LoadTextCells(char const* path)
+{
+	CellList result = ReadText<CellList>(path);
+	result.Sort();
+	return result;
+}
+
+/******************************************************************************/
+/*!
+Loads a pattern in the format given by the extension of the path
+
+\param path
+File to load, .rle and .golb pick those formats, anything else is text
+
+\return
+The pattern
+*/
+/******************************************************************************/
+Pattern LoadPattern(char const* path)
+{
+	if (HasExtension(path, ".rle"))
+	{
+		return LoadRle(path);
+	}
+
+	if (HasExtension(path, ".golb"))
+	{
+		return LoadBitmap(path);
+	}
+
+	return LoadText(path);
+}
+
+/******************************************************************************/
+/*!
+Writes a pattern in the binary bitmap format
+
+\param pattern
+Pattern to write
+
+\param path
+File to write
+*/
+/******************************************************************************/
+void SaveBitmap(Pattern const& pattern, char const* path)
+{
+	std::FILE* file = std::fopen(path, "wb");
+	if (!file)
+	{
+		throw "cannot create binary bitmap file";
+	}
+
+	unsigned char header[kBitmapHeader] = {};
+	uint32_t const fields[3] = { kBitmapMagic, static_cast<uint32_t>(pattern.Width()), static_cast<uint32_t>(pattern.Height()) };
+	for (int i = 0; i < 3; ++i)
+	{
+		for (int b = 0; b < 4; ++b)
+		{
+			header[i * 4 + b] = static_cast<unsigned char>(fields[i] >> (8 * b));
+		}
+	}
+
+	bool ok = std::fwrite(header, 1, sizeof(header), file) == sizeof(header);
+
+	//Rows are written as they are held, the format is little endian like the host
+	for (int y = 0; ok && y < pattern.Height(); ++y)
+	{
+		ok = std::fwrite(pattern.Row(y), sizeof(uint64_t), pattern.Words(), file) == static_cast<size_t>(pattern.Words());
+	}
+
+	if (std::fclose(file) != 0 || !ok)
+	{
+		throw "cannot write binary bitmap file";
+	}
+}
+
+/******************************************************************************/
+/*!
+Writes a pattern in the standard run length encoded format. Runs are found a
+word at a time, dead cells at the end of a row and empty rows at the end of
+the board are left out, and the whole file is built in memory and written
+at once.
+
+\param pattern
+Pattern to write
+
+\param path
+File to write
+
+\param comments
+Text of the #C lines to write above the header
+*/
+/******************************************************************************/
+void SaveRle(Pattern const& pattern, char const* path, std::vector<std::string> const& comments)
+{
+	std::string out = RleHeader(pattern, comments);
+
+	int line = 0;
+	int rows = 0; // row ends not yet written
+	for (int y = 0; y < pattern.Height(); ++y)
+	{
+		uint64_t const* row = pattern.Row(y);
+		int x = 0;
+		for (;;)
+		{
+			int const start = NextCell(row, pattern.Width(), x, true);
+			if (start == pattern.Width())
+			{
+				break;
+			}
+			int const stop = NextCell(row, pattern.Width(), start, false);
+
+			if (rows > 0)
+			{
+				PutRun(&out, &line, rows, '$');
+				rows = 0;
+			}
+			if (start > x)
+			{
+				PutRun(&out, &line, start - x, 'b');
+			}
+			PutRun(&out, &line, stop - start, 'o');
+			x = stop;
+		}
+		++rows;
+	}
+	PutRun(&out, &line, 1, '!');
+	out += '\n';
+
+	WriteRle(out, path);
+}
+
+/******************************************************************************/
+/*!
+Writes a list of live cells in the standard run length encoded format, the
+same text SaveRle writes for a pattern holding those cells. Only the cells
+are visited, so the size of the board costs nothing.
+
+\param cells
+Cells to write, in row major order
+
+\param path
+File to write
+
+\param comments
+Text of the #C lines to write above the header
+*/
+/******************************************************************************/
+void SaveRle(CellList const& cells, char const* path, std::vector<std::string> const& comments)
+{
+	std::string out = RleHeader(cells, comments);
+
+	std::vector< std::tuple<int, int> > const& live = cells.Cells();
+	int line = 0;
+	int x = 0, y = 0; // first cell not written yet
+	for (size_t i = 0; i < live.size();)
+	{
+		int const start = std::get<0>(live[i]);
+		int const row = std::get<1>(live[i]);
+
+		//Cells next to each other on a row make one run
+		size_t next = i + 1;
+		while (next < live.size() && std::get<1>(live[next]) == row && std::get<0>(live[next]) == start + static_cast<int>(next - i))
+		{
+			++next;
+		}
+
+		if (row > y)
+		{
+			PutRun(&out, &line, row - y, '$');
+			x = 0;
+			y = row;
+		}
+		if (start > x)
+		{
+			PutRun(&out, &line, start - x, 'b');
+		}
+		PutRun(&out, &line, static_cast<int>(next - i), 'o');
+		x = start + static_cast<int>(next - i);
+		i = next;
+	}
+	PutRun(&out, &line, 1, '!');
+	out += '\n';
+
+	WriteRle(out, path);
+}
@@ -0,0 +1,101 @@
+/******************************************************************************/
+/*!
+\file   pattern.h
+\author Isaac Hill
+\par    email: Isaac.Hill@digipen.edu
+\par    DigiPen login: Isaac.Hill
+\par    Course: CS355
+\par    Assignment #1
+\date   1/21/2020
+\brief
+This is the Header file for loading and saving starting boards, as RLE
+patterns, compact binary bitmaps or the driver's text format
+*/
+/******************************************************************************/
+
+#ifndef PATTERN_H
+#define PATTERN_H
+
+#include "gol.h"
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <tuple>
+#include <vector>
+
+/******************************************************************************/
+/*!
+Bit packed board, bit x % 64 of word x / 64 of a row is cell x. It is the
+same layout the binary bitmap format stores, so loading one is a copy of
+each row. Any engine can be started from it through run.
+*/
+/******************************************************************************/
+class Pattern : public BoardView
+{
+public:
+	Pattern(int width, int height);
+
+	int Words() const { return words_; }
+	uint64_t* Row(int y) { return &cells_[static_cast<size_t>(y) * words_]; }
+	uint64_t const* Row(int y) const { return &cells_[static_cast<size_t>(y) * words_]; }
+
+	void Set(int x, int y) { Row(y)[x / 64] |= uint64_t(1) << (x % 64); }
+	bool Alive(int x, int y) const { return (Row(y)[x / 64] >> (x % 64)) & 1; }
+	void ForEachLive(std::function<void(int, int)> const& visit) const;
+
+private:
+	int words_; // words holding one row
+	std::vector<uint64_t> cells_;
+};
+
+/******************************************************************************/
+/*!
+Board held as the list of its live cells, memory follows the population and
+not the size of the board. Cells are kept in row major order, Set must be
+called in that order unless Sort is called before the board is read.
+*/
+/******************************************************************************/
+class CellList : public BoardView
+{
+public:
+	CellList(int width, int height) : BoardView(width, height) {}
+
+	std::vector< std::tuple<int, int> > const& Cells() const { return cells_; }
+
+	void Set(int x, int y) { cells_.push_back(std::make_tuple(x, y)); }
+	void Sort();
+	bool Alive(int x, int y) const;
+	void ForEachLive(std::function<void(int, int)> const& visit) const;
+
+private:
+	std::vector< std::tuple<int, int> > cells_; // (x, y) of every live cell
+};
+
+// If a bit packed board of this size fits in the memory of the host, Pattern
+// throws a message when it does not
+bool FitsBitPacked(int width, int height);
+
+// Each loader maps the file and throws a message if it cannot be read or parsed,
+// LoadRle can also hand back the text of the #C comment lines
+Pattern LoadRle(char const* path, std::vector<std::string>* comments = 0);
+Pattern LoadBitmap(char const* path);
+Pattern LoadText(char const* path);
+
+// Same as above, only the live cells are kept so the board can be of any size
+CellList LoadRleCells(char const* path, std::vector<std::string>* comments = 0);
+CellList LoadTextCells(char const* path);
+
+// Reads only the size in the header of an RLE pattern
+void LoadRleSize(char const* path, int* width, int* height);
+
+// Picks the loader from the extension, .rle, .golb or anything else as text
+Pattern LoadPattern(char const* path);
+
+void SaveBitmap(Pattern const& pattern, char const* path);
+
+// Each comment is written as a #C line above the header
+void SaveRle(Pattern const& pattern, char const* path, std::vector<std::string> const& comments = std::vector<std::string>());
+void SaveRle(CellList const& cells, char const* path, std::vector<std::string> const& comments = std::vector<std::string>());
+
+#endif
@@ -0,0 +1,493 @@
+/******************************************************************************/
+/*!
+\file   pool.cpp
+\author Isaac Hill
+\par    email: Isaac.Hill@digipen.edu
+\par    DigiPen login: Isaac.Hill
+\par    Course: CS355
+\par    Assignment #1
+\date   1/21/2020
+\brief
+This is the Implementation file for the worker pool and reusable barrier
+*/
+/******************************************************************************/
+
+#include "pool.h"
+#include "numa.h"
+
+#include <climits>
+#include <thread>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#else
+#include <sched.h>
+#endif
+
+namespace
+{
+	/******************************************************************************/
+	/*!
+	Sleeps while a word still holds a value
+
+	\param word
+	Word to sleep on
+
+	\param value
+	Value the word had when the caller decided to sleep
+	*/
+	/******************************************************************************/
+	void FutexWait(std::atomic<uint32_t>* word, uint32_t value)
+	{
+#ifdef __linux__
+		syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAIT_PRIVATE, value, 0, 0, 0);
+#else
+		if (word->load(std::memory_order_relaxed) == value)
+		{
+			sched_yield();
+		}
+#endif
+	}
+
+	/******************************************************************************/
+	/*!
+	Wakes every thread sleeping on a word
+
+	\param word
+	Word that changed
+	*/
+	/******************************************************************************/
+	void FutexWake(std::atomic<uint32_t>* word)
+	{
+#ifdef __linux__
+		syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAKE_PRIVATE, INT_MAX, 0, 0, 0);
+#else
+		static_cast<void>(word);
+#endif
+	}
+
+	/******************************************************************************/
+	/*!
+	Tells the core this thread is spinning
+	*/
+	/******************************************************************************/
+	inline void Pause()
+	{
+#if defined(__x86_64__) || defined(__i386__)
+		__builtin_ia32_pause();
+#endif
+	}
+}
+
+/******************************************************************************/
+/*!
+Creates a barrier for a fixed number of threads
+
+\param num_threads
+Number of threads that must arrive before any are released
+
+\param kind
+Central counter or dissemination rounds
+*/
+/******************************************************************************/
+Barrier::Barrier(int num_threads, BarrierKind kind)
+	: kind_(kind), num_threads_(num_threads), rounds_(0), spins_(0), count_(num_threads)
+{
+	generation_.value = 0;
+	generation_.sleepers = 0;
+
+	//Spinning only helps when every thread has a core of its own
+	int const cores = static_cast<int>(std::thread::hardware_concurrency());
+	spins_ = cores > 1 && num_threads <= cores ? 4000 : 0;
+
+	if (kind_ == BarrierKind::kDissemination)
+	{
+		while ((1 << rounds_) < num_threads_)
+		{
+			++rounds_;
+		}
+
+		nodes_ = std::vector<Node>(num_threads_);
+		for (int i = 0; i < num_threads_; ++i)
+		{
+			nodes_[i].episode = 0;
+			for (int r = 0; r < kMaxRounds; ++r)
+			{
+				nodes_[i].flags[r].value = 0;
+				nodes_[i].flags[r].sleepers = 0;
+			}
+		}
+	}
+}
+
+/******************************************************************************/
+/*!
+Blocks until all threads have called Wait, safe to call again right away
+
+\param thread
+Index of the calling thread
+*/
+/******************************************************************************/
+void Barrier::Wait(int thread)
+{
+	if (kind_ == BarrierKind::kDissemination)
+	{
+		WaitDissemination(thread);
+	}
+	else
+	{
+		WaitCentral();
+	}
+}
+
+/******************************************************************************/
+/*!
+Sense reversing counter, the generation word is the sense. The last thread
+in resets the count before it flips the sense, so nobody can arrive at the
+next barrier before the count is ready for them.
+*/
+/******************************************************************************/
+void Barrier::WaitCentral()
+{
+	uint32_t const sense = generation_.value.load(std::memory_order_acquire);
+
+	if (count_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+	{
+		count_.store(num_threads_, std::memory_order_relaxed);
+		Signal(&generation_);
+		return;
+	}
+
+	Await(&generation_, sense, false);
+}
+
+/******************************************************************************/
+/*!
+Dissemination barrier, in round r thread i signals thread i + 2^r and waits
+for thread i - 2^r. The flags count episodes instead of holding a sense, so a
+partner that is already one barrier ahead cannot be mistaken for this one.
+
+\param thread
+Index of the calling thread
+*/
+/******************************************************************************/
+void Barrier::WaitDissemination(int thread)
+{
+	Node& node = nodes_[thread];
+	uint32_t const episode = ++node.episode;
+
+	for (int r = 0; r < rounds_; ++r)
+	{
+		int const partner = (thread + (1 << r)) % num_threads_;
+		Signal(&nodes_[partner].flags[r]);
+		Await(&node.flags[r], episode, true);
+	}
+}
+
+/******************************************************************************/
+/*!
+Spins and then sleeps until a flag reaches a value
+
+\param flag
+Flag to watch
+
+\param target
+Value to wait for, or the value to wait to go away from
+
+\param equal
+True to wait until the flag has reached target, false to wait until it no
+longer holds it
+*/
+/******************************************************************************/
+void Barrier::Await(Flag* flag, uint32_t target, bool equal) const
+{
+	for (int i = 0; i < spins_; ++i)
+	{
+		uint32_t const value = flag->value.load(std::memory_order_acquire);
+		if (equal ? static_cast<int32_t>(value - target) >= 0 : value != target)
+		{
+			return;
+		}
+		Pause();
+	}
+
+	//Announce the sleeper before the last look, Signal checks it after the store
+	flag->sleepers.fetch_add(1);
+	for (;;)
+	{
+		uint32_t const value = flag->value.load();
+		if (equal ? static_cast<int32_t>(value - target) >= 0 : value != target)
+		{
+			break;
+		}
+		FutexWait(&flag->value, value);
+	}
+	flag->sleepers.fetch_sub(1);
+}
+
+/******************************************************************************/
+/*!
+Moves a flag forward and wakes whoever sleeps on it
+
+\param flag
+Flag to signal
+*/
+/******************************************************************************/
+void Barrier::Signal(Flag* flag)
+{
+	flag->value.fetch_add(1);
+	if (flag->sleepers.load() > 0)
+	{
+		FutexWake(&flag->value);
+	}
+}
+
+/******************************************************************************/
+/*!
+Creates one empty queue per worker
+
+\param num_workers
+Number of workers that take tasks
+*/
+/******************************************************************************/
+TaskQueues::TaskQueues(int num_workers) : ranges_(num_workers), steals_(0)
+{
+	for (int i = 0; i < num_workers; ++i)
+	{
+		ranges_[i].bounds = 0;
+	}
+}
+
+/******************************************************************************/
+/*!
+Fills the queue of one worker with a contiguous share of the tasks. Every
+queue is empty once all workers have passed the barrier that ends a round, so
+refilling needs no other synchronization.
+
+\param worker
+Index of the worker
+
+\param num_tasks
+Number of tasks in this round
+*/
+/******************************************************************************/
+void TaskQueues::Reset(int worker, int num_tasks)
+{
+	int const num_workers = static_cast<int>(ranges_.size());
+	uint64_t const begin = static_cast<uint64_t>(num_tasks) * worker / num_workers;
+	uint64_t const end = static_cast<uint64_t>(num_tasks) * (worker + 1) / num_workers;
+
+	ranges_[worker].bounds.store((begin << 32) | end);
+}
+
+/******************************************************************************/
+/*!
+Takes a task from the worker's own queue, or steals half of another queue
+
+\param worker
+Index of the worker
+
+\param task
+Receives the task index
+
+\return
+True if a task was taken, false if every queue is empty
+*/
+/******************************************************************************/
+bool TaskQueues::Next(int worker, int* task)
+{
+	std::atomic<uint64_t>& own = ranges_[worker].bounds;
+
+	uint64_t bounds = own.load();
+	while ((bounds >> 32) < (bounds & 0xffffffff))
+	{
+		if (own.compare_exchange_weak(bounds, bounds + (uint64_t(1) << 32)))
+		{
+			*task = static_cast<int>(bounds >> 32);
+			return true;
+		}
+	}
+
+	int const num_workers = static_cast<int>(ranges_.size());
+	for (int i = 1; i < num_workers; ++i)
+	{
+		std::atomic<uint64_t>& victim = ranges_[(worker + i) % num_workers].bounds;
+
+		bounds = victim.load();
+		for (;;)
+		{
+			uint64_t const begin = bounds >> 32;
+			uint64_t const end = bounds & 0xffffffff;
+			if (begin >= end)
+			{
+				break;
+			}
+
+			uint64_t const middle = begin + (end - begin) / 2;
+			if (victim.compare_exchange_weak(bounds, (begin << 32) | middle))
+			{
+				//Our own queue is empty, so nobody else is touching it
+				*task = static_cast<int>(middle);
+				own.store(((middle + 1) << 32) | end);
+				++steals_;
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+/******************************************************************************/
+/*!
+Number of workers to use when the caller does not ask for a count
+
+\return
+The hardware concurrency, at least 1
+*/
+/******************************************************************************/
+int WorkerPool::DefaultSize()
+{
+	int const size = static_cast<int>(std::thread::hardware_concurrency());
+	return size > 0 ? size : 1;
+}
+
+/******************************************************************************/
+/*!
+Creates all worker threads, they sleep until a job is run. Pinned worker i
+gets core i * cores / num_threads of the node ordered list, so with more
+workers than cores the ones that share a core are neighbors too.
+
+\param num_threads
+Number of workers, 0 or less uses DefaultSize
+
+\param pin
+Pin every worker to one core
+*/
+/******************************************************************************/
+WorkerPool::WorkerPool(int num_threads, bool pin) : job_(0), quit_(false)
+{
+	if (num_threads <= 0)
+	{
+		num_threads = DefaultSize();
+	}
+
+	sem_init(&done_, 0, 0);
+
+	threads_.resize(num_threads);
+	workers_.resize(num_threads);
+
+	for (int i = 0; i < num_threads; ++i)
+	{
+		workers_[i].pool = this;
+		workers_[i].index = i;
+		sem_init(&workers_[i].start, 0, 0);
+	}
+
+	std::vector<Cpu> const cpus = pin ? CpusByNode() : std::vector<Cpu>();
+	if (!cpus.empty())
+	{
+		nodes_.resize(num_threads);
+	}
+
+	for (int i = 0; i < num_threads; ++i)
+	{
+		pthread_attr_t attr;
+		pthread_attr_init(&attr);
+
+		if (!cpus.empty())
+		{
+			Cpu const& cpu = cpus[static_cast<size_t>(i) * cpus.size() / num_threads];
+			nodes_[i] = cpu.node;
+#ifdef __linux__
+			cpu_set_t set;
+			CPU_ZERO(&set);
+			CPU_SET(cpu.id, &set);
+			pthread_attr_setaffinity_np(&attr, sizeof(set), &set);
+#endif
+		}
+
+		pthread_create(&threads_[i], &attr, Work, &workers_[i]);
+		pthread_attr_destroy(&attr);
+	}
+}
+
+/******************************************************************************/
+/*!
+Wakes every worker with the quit flag set and joins them
+*/
+/******************************************************************************/
+WorkerPool::~WorkerPool()
+{
+	quit_ = true;
+
+	for (unsigned i = 0; i < workers_.size(); ++i)
+	{
+		sem_post(&workers_[i].start);
+	}
+
+	for (unsigned i = 0; i < threads_.size(); ++i)
+	{
+		pthread_join(threads_[i], 0);
+		sem_destroy(&workers_[i].start);
+	}
+
+	sem_destroy(&done_);
+}
+
+/******************************************************************************/
+/*!
+Runs a job on every worker and waits for all of them to finish
+
+\param job
+Function called once per worker with the worker index
+*/
+/******************************************************************************/
+void WorkerPool::Run(std::function<void(int)> const& job)
+{
+	job_ = &job;
+
+	for (unsigned i = 0; i < workers_.size(); ++i)
+	{
+		sem_post(&workers_[i].start);
+	}
+
+	for (unsigned i = 0; i < workers_.size(); ++i)
+	{
+		sem_wait(&done_);
+	}
+
+	job_ = 0;
+}
+
+/******************************************************************************/
+/*!
+Main loop of a worker thread
+
+\param p
+The Worker this thread belongs to
+*/
+/******************************************************************************/
+void* WorkerPool::Work(void* p)
+{
+	Worker* worker = reinterpret_cast<Worker*>(p);
+	WorkerPool* pool = worker->pool;
+
+	for (;;)
+	{
+		sem_wait(&worker->start);
+
+		if (pool->quit_)
+		{
+			break;
+		}
+
+		(*pool->job_)(worker->index);
+
+		sem_post(&pool->done_);
+	}
+
+	return NULL;
+}
@@ -0,0 +1,162 @@
+/******************************************************************************/
+/*!
+\file   pool.h
+\author Isaac Hill
+\par    email: Isaac.Hill@digipen.edu
+\par    DigiPen login: Isaac.Hill
+\par    Course: CS355
+\par    Assignment #1
+\date   1/21/2020
+\brief
+This is the Header file for the fixed size worker pool and the reusable
+barrier used by the pooled game of life engines
+*/
+/******************************************************************************/
+
+#ifndef POOL_H
+#define POOL_H
+
+#include "gol.h"
+
+#include <pthread.h>
+#include <semaphore.h>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+/******************************************************************************/
+/*!
+Reusable barrier that needs no locks. The central kind counts arrivals on one
+atomic and the last thread in flips the generation, the dissemination kind
+signals a different partner in each of log2(n) rounds. Waiting threads spin
+for a short while and then sleep on a futex, so a barrier that is crossed
+quickly never makes a system call.
+*/
+/******************************************************************************/
+class Barrier
+{
+public:
+	Barrier(int num_threads, BarrierKind kind = BarrierKind::kCentral);
+
+	// thread is the index of the caller, 0 to num_threads - 1
+	void Wait(int thread);
+
+private:
+	Barrier(Barrier const&);
+	Barrier& operator=(Barrier const&);
+
+	static int const kMaxRounds = 32;
+
+	// Word a thread can sleep on, padded out to a cache line
+	struct Flag
+	{
+		std::atomic<uint32_t> value;
+		std::atomic<int> sleepers;
+		char pad[56];
+	};
+
+	// Per thread state of the dissemination barrier
+	struct Node
+	{
+		Flag flags[kMaxRounds];
+		uint32_t episode;
+		char pad[60];
+	};
+
+	void WaitCentral();
+	void WaitDissemination(int thread);
+	void Await(Flag* flag, uint32_t target, bool equal) const;
+	static void Signal(Flag* flag);
+
+	BarrierKind kind_;
+	int num_threads_;
+	int rounds_;
+	int spins_;
+	std::atomic<int> count_;
+	char pad_[64];
+	Flag generation_;
+	std::vector<Node> nodes_;
+};
+
+/******************************************************************************/
+/*!
+Work stealing queues of task indices. Each worker owns a range of tasks and
+takes them from the front, a worker whose range is empty steals the back half
+of somebody else's. A range is one atomic word so taking and stealing are
+both a single compare and swap.
+*/
+/******************************************************************************/
+class TaskQueues
+{
+public:
+	explicit TaskQueues(int num_workers);
+
+	// Gives worker its even share of tasks 0 to num_tasks - 1, called by that worker
+	void Reset(int worker, int num_tasks);
+
+	// Takes the next task for worker, false once every queue is empty
+	bool Next(int worker, int* task);
+
+	long long Steals() const { return steals_; }
+
+private:
+	TaskQueues(TaskQueues const&);
+	TaskQueues& operator=(TaskQueues const&);
+
+	// Tasks begin to end packed in one word, padded out to a cache line
+	struct Range
+	{
+		std::atomic<uint64_t> bounds;
+		char pad[56];
+	};
+
+	std::vector<Range> ranges_;
+	std::atomic<long long> steals_;
+};
+
+/******************************************************************************/
+/*!
+Fixed size set of threads that are created once and reused for every job.
+Pinned workers are spread over the cores in node order, so workers with
+neighboring indices share a node.
+*/
+/******************************************************************************/
+class WorkerPool
+{
+public:
+	explicit WorkerPool(int num_threads, bool pin = false);
+	~WorkerPool();
+
+	int Size() const { return static_cast<int>(threads_.size()); }
+
+	// Node the worker is pinned to, -1 if the pool is not pinned
+	int Node(int worker) const { return nodes_.empty() ? -1 : nodes_[worker]; }
+
+	// Runs job(worker_index) on every worker and returns once they all finish
+	void Run(std::function<void(int)> const& job);
+
+	static int DefaultSize();
+
+private:
+	WorkerPool(WorkerPool const&);
+	WorkerPool& operator=(WorkerPool const&);
+
+	struct Worker
+	{
+		WorkerPool* pool;
+		int index;
+		sem_t start;
+	};
+
+	static void* Work(void* p);
+
+	std::vector<pthread_t> threads_;
+	std::vector<Worker> workers_;
+	std::vector<int> nodes_;
+	std::function<void(int)> const* job_;
+	bool quit_;
+	sem_t done_;
+};
+
+#endif
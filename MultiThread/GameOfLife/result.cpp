@@ -0,0 +1,341 @@
+/******************************************************************************/
+/*!
+\file   result.cpp
+\author Isaac Hill
+\par    email: Isaac.Hill@digipen.edu
+\par    DigiPen login: Isaac.Hill
+\par    Course: CS355
+\par    Assignment #1
+\date   1/21/2020
+\brief
+This is the Implementation file for the bitmap view of a final board, its
+row major live cell iterator and the buffered renderer
+*/
+/******************************************************************************/
+
+#include "result.h"
+#include "simulation.h"
+
+#include <ostream>
+#include <string>
+
+namespace
+{
+	size_t const kChunk = size_t(1) << 20; // bytes the renderer collects before it writes
+
+	/******************************************************************************/
+	/*!
+	Appends a character right aligned in a field, the way std::setw pads it
+
+	\param out
+	Buffer to append to
+
+	\param width
+	Width of the field
+
+	\param c
+	Character to append
+
+	\param fill
+	Character the field is padded with
+	*/
+	/******************************************************************************/
+	void Pad(std::string* out, int width, char c, char fill = ' ')
+	{
+		if (width > 1)
+		{
+			out->append(width - 1, fill);
+		}
+		*out += c;
+	}
+
+	/******************************************************************************/
+	/*!
+	Appends a row number right aligned in three columns
+
+	\param out
+	Buffer to append to
+
+	\param number
+	Number to append, longer ones are not cut
+	*/
+	/******************************************************************************/
+	void PadNumber(std::string* out, int number)
+	{
+		std::string const text = std::to_string(number);
+		if (text.size() < 3)
+		{
+			out->append(3 - text.size(), ' ');
+		}
+		*out += text;
+	}
+
+	/******************************************************************************/
+	/*!
+	Writes out the buffer once it holds a chunk
+
+	\param buffer
+	Text not written yet, emptied when it is written
+
+	\param out
+	Stream to write to
+	*/
+	/******************************************************************************/
+	void Flush(std::string* buffer, std::ostream& out)
+	{
+		if (buffer->size() >= kChunk)
+		{
+			out.write(buffer->data(), buffer->size());
+			buffer->clear();
+		}
+	}
+}
+
+/******************************************************************************/
+/*!
+Visits the live cells a word at a time, row by row
+
+\param visit
+Called with the coordinates of each live cell
+*/
+/******************************************************************************/
+void Bitmap::ForEachLive(std::function<void(int, int)> const& visit) const
+{
+	int const words = Words();
+	uint64_t const tail = (Width() % 64) ? (uint64_t(1) << (Width() % 64)) - 1 : ~uint64_t(0);
+
+	for (int y = 0; y < Height(); ++y)
+	{
+		uint64_t const* row = Row(y);
+		for (int w = 0; w < words; ++w)
+		{
+			uint64_t word = w + 1 < words ? row[w] : row[w] & tail;
+			while (word)
+			{
+				visit(w * 64 + __builtin_ctzll(word), y);
+				word &= word - 1;
+			}
+		}
+	}
+}
+
+/******************************************************************************/
+/*!
+Creates an iterator at the first live cell of a row or after it
+
+\param board
+Board to walk
+
+\param y
+Row to start on, the height of the board for the end
+*/
+/******************************************************************************/
+Bitmap::Iterator::Iterator(Bitmap const* board, int y) : board_(board), x_(0), y_(y), word_(0), bits_(0)
+{
+	if (y_ >= board_->Height() || board_->Words() == 0)
+	{
+		y_ = board_->Height();
+		return;
+	}
+
+	bits_ = Bits(y_, 0);
+	++*this;
+}
+
+/******************************************************************************/
+/*!
+Moves to the next live cell, skipping a whole word of dead cells at a time
+
+\return
+The iterator, equal to end once there are no more live cells
+*/
+/******************************************************************************/
+Bitmap::Iterator& Bitmap::Iterator::operator++()
+{
+	int const height = board_->Height();
+	int const words = board_->Words();
+
+	while (bits_ == 0)
+	{
+		if (++word_ == words)
+		{
+			word_ = 0;
+			if (++y_ == height)
+			{
+				x_ = 0;
+				return *this;
+			}
+		}
+		bits_ = Bits(y_, word_);
+	}
+
+	x_ = word_ * 64 + __builtin_ctzll(bits_);
+	bits_ &= bits_ - 1;
+	return *this;
+}
+
+/******************************************************************************/
+/*!
+Cells of one word of the board, without the bits past the width
+
+\param y
+Row
+
+\param word
+Word of the row
+
+\return
+Bit set for every live cell
+*/
+/******************************************************************************/
+uint64_t Bitmap::Iterator::Bits(int y, int word) const
+{
+	uint64_t bits = board_->Row(y)[word];
+	if (word + 1 == board_->Words() && board_->Width() % 64)
+	{
+		bits &= (uint64_t(1) << (board_->Width() % 64)) - 1;
+	}
+	return bits;
+}
+
+/******************************************************************************/
+/*!
+Takes the final board of a simulation. An engine that keeps the board bit
+packed is kept alive and read in place, any other one is packed into a copy
+and freed.
+
+\param simulation
+Engine after its last generation
+*/
+/******************************************************************************/
+RunResult::RunResult(std::unique_ptr<Simulation> simulation) : simulation_(std::move(simulation))
+{
+	if (simulation_->GetBitmap(&view_))
+	{
+		return;
+	}
+
+	copy_.reset(new Pattern(simulation_->Width(), simulation_->Height()));
+	Pattern* cells = copy_.get();
+	simulation_->ForEachLive([cells](int x, int y) { cells->Set(x, y); });
+	simulation_.reset();
+
+	bool const empty = copy_->Words() == 0 || copy_->Height() == 0;
+	view_ = Bitmap(copy_->Width(), copy_->Height(), empty ? 0 : copy_->Row(0), copy_->Words());
+}
+
+/******************************************************************************/
+/*!
+Move constructor, the view keeps pointing at the same storage
+
+\param rhs
+Result to take over
+*/
+/******************************************************************************/
+RunResult::RunResult(RunResult&& rhs)
+	: simulation_(std::move(rhs.simulation_)), copy_(std::move(rhs.copy_)), view_(rhs.view_)
+{
+}
+
+/******************************************************************************/
+/*!
+Frees the engine or the copy
+*/
+/******************************************************************************/
+RunResult::~RunResult()
+{
+}
+
+/******************************************************************************/
+/*!
+Draws a board character for character the same as the driver's draw, from
+the live cells in the order the bitmap gives them, so nothing is sorted.
+Rows of dead cells become one run of spaces and the text is collected in a
+buffer that is written a megabyte at a time.
+
+\param board
+Board to draw
+
+\param out
+Stream to draw on
+*/
+/******************************************************************************/
+void Render(Bitmap const& board, std::ostream& out)
+{
+	int const max_x = board.Width();
+	int const max_y = board.Height();
+
+	std::string buffer;
+	buffer.reserve(kChunk + 4096);
+
+	//Column numbers, tens then ones
+	buffer += "    ";
+	if (max_x >= 12)
+	{
+		for (int i = 0; i < max_x; ++i)
+		{
+			buffer += std::to_string(i / 10);
+		}
+	}
+	buffer += "\n    ";
+	for (int i = 0; i < max_x; ++i)
+	{
+		buffer += static_cast<char>('0' + i % 10);
+	}
+	buffer += "\n   +";
+	Pad(&buffer, max_x + 1, '+', '-');
+	buffer += "--> x";
+
+	int old_y = -1;
+	int old_x = -1;
+	for (Bitmap::Iterator it = board.begin(); it != board.end(); ++it)
+	{
+		int x, y;
+		std::tie(x, y) = *it;
+
+		//Finish the rows before this cell and start its own
+		for (int j = old_y; j < y; ++j)
+		{
+			if (j != -1)
+			{
+				Pad(&buffer, max_x - old_x, '|');
+			}
+			if (j < max_y - 1)
+			{
+				buffer += '\n';
+				PadNumber(&buffer, j + 1);
+				buffer += '|';
+			}
+			old_x = -1;
+
+			Flush(&buffer, out);
+		}
+
+		Pad(&buffer, x - old_x, '*');
+		old_x = x;
+		old_y = y;
+
+		Flush(&buffer, out);
+	}
+
+	for (int j = old_y; j < max_y; ++j)
+	{
+		Pad(&buffer, max_x - old_x, '|');
+		buffer += '\n';
+		if (j < max_y - 1)
+		{
+			PadNumber(&buffer, j + 1);
+			buffer += '|';
+		}
+		old_x = -1;
+
+		Flush(&buffer, out);
+	}
+
+	buffer += "   +";
+	Pad(&buffer, max_x + 1, '+', '-');
+	buffer += "\n   |\n   V  y\n";
+
+	out.write(buffer.data(), buffer.size());
+	out.flush();
+}
@@ -0,0 +1,128 @@
+/******************************************************************************/
+/*!
+\file   result.h
+\author Isaac Hill
+\par    email: Isaac.Hill@digipen.edu
+\par    DigiPen login: Isaac.Hill
+\par    Course: CS355
+\par    Assignment #1
+\date   1/21/2020
+\brief
+This is the Header file for reading the final board of a run in place. The
+bit packed engines hand out their own storage, the others are packed into a
+bitmap once, and the live cells come out in row major order without a sort.
+*/
+/******************************************************************************/
+
+#ifndef RESULT_H
+#define RESULT_H
+
+#include "gol.h"
+#include "pattern.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <iterator>
+#include <memory>
+#include <tuple>
+
+class Simulation;
+
+/******************************************************************************/
+/*!
+Read only look at a bit packed board owned by somebody else. Bit x % 64 of
+word x / 64 of Row(y) is cell x, bits past the width are ignored so they
+can hold anything, such as the border of a torus.
+*/
+/******************************************************************************/
+class Bitmap : public BoardView
+{
+public:
+	Bitmap() : BoardView(0, 0), rows_(0), stride_(0) {}
+	Bitmap(int width, int height, uint64_t const* rows, ptrdiff_t stride) : BoardView(width, height), rows_(rows), stride_(stride) {}
+
+	int Words() const { return (Width() + 63) / 64; }
+	uint64_t const* Row(int y) const { return rows_ + y * stride_; }
+
+	bool Alive(int x, int y) const { return (Row(y)[x / 64] >> (x % 64)) & 1; }
+
+	// Calls visit(x, y) for every live cell, row by row from the left
+	void ForEachLive(std::function<void(int, int)> const& visit) const;
+
+	// Walks the live cells in row major order, *it is the (x, y) of the cell
+	class Iterator
+	{
+	public:
+		typedef std::forward_iterator_tag iterator_category;
+		typedef std::tuple<int, int> value_type;
+		typedef ptrdiff_t difference_type;
+		typedef value_type const* pointer;
+		typedef value_type reference;
+
+		Iterator() : board_(0), x_(0), y_(0), word_(0), bits_(0) {}
+		Iterator(Bitmap const* board, int y);
+
+		std::tuple<int, int> operator*() const { return std::make_tuple(x_, y_); }
+		Iterator& operator++();
+		Iterator operator++(int) { Iterator before = *this; ++*this; return before; }
+
+		bool operator==(Iterator const& rhs) const { return x_ == rhs.x_ && y_ == rhs.y_; }
+		bool operator!=(Iterator const& rhs) const { return !(*this == rhs); }
+
+	private:
+		uint64_t Bits(int y, int word) const;
+
+		Bitmap const* board_;
+		int x_;
+		int y_;
+		int word_;      // word of row y_ the next cell is looked for in
+		uint64_t bits_; // live cells of that word not visited yet
+	};
+
+	Iterator begin() const { return Iterator(this, 0); }
+	Iterator end() const { return Iterator(this, Height()); }
+
+private:
+	uint64_t const* rows_;
+	ptrdiff_t stride_; // words from one row to the next
+};
+
+/******************************************************************************/
+/*!
+Final board of a run. It keeps the engine alive when the engine stores the
+board bit packed and points into it, otherwise it holds a packed copy.
+*/
+/******************************************************************************/
+class RunResult
+{
+public:
+	explicit RunResult(std::unique_ptr<Simulation> simulation);
+	RunResult(RunResult&& rhs);
+	~RunResult();
+
+	Bitmap const& View() const { return view_; }
+	Bitmap::Iterator begin() const { return view_.begin(); }
+	Bitmap::Iterator end() const { return view_.end(); }
+
+private:
+	RunResult(RunResult const&);
+	RunResult& operator=(RunResult const&);
+
+	std::unique_ptr<Simulation> simulation_; // null when copy_ holds the board
+	std::unique_ptr<Pattern> copy_;
+	Bitmap view_;
+};
+
+// Same as run, the final board is read in place instead of copied out as a list.
+// The board must fit in memory bit packed, a larger one throws a message
+// before it is run
+RunResult run_bitmap(BoardView const& initial, int num_iter, Options const& options);
+RunResult run_bitmap(std::vector< std::tuple<int, int> > const& initial_population, int num_iter, int max_x, int max_y,
+                     Options const& options);
+
+// Draws a board the way the driver always has, a whole row at a time into a
+// buffer that is written out in large chunks
+void Render(Bitmap const& board, std::ostream& out);
+
+#endif
@@ -0,0 +1,110 @@
+/******************************************************************************/
+/*!
+\file   rule.cpp
+\author Isaac Hill
+\par    email: Isaac.Hill@digipen.edu
+\par    DigiPen login: Isaac.Hill
+\par    Course: CS355
+\par    Assignment #1
+\date   1/21/2020
+\brief
+This is the Implementation file for reading B/S rule strings
+*/
+/******************************************************************************/
+
+#include "rule.h"
+
+/******************************************************************************/
+/*!
+Reads a rule written as "B36/S23". The two halves can come in either order
+and the letters can be lower case, "B2/S" is a rule where nothing survives.
+
+\param text
+Rule to read
+
+\return
+The rule
+*/
+/******************************************************************************/
+Rule ParseRule(char const* text)
+{
+	Rule result = { 0, 0 };
+	bool seen_birth = false;
+	bool seen_survive = false;
+
+	char const* c = text;
+	for (int half = 0; half < 2; ++half)
+	{
+		uint16_t* counts;
+		if ((*c == 'B' || *c == 'b') && !seen_birth)
+		{
+			counts = &result.birth;
+			seen_birth = true;
+		}
+		else if ((*c == 'S' || *c == 's') && !seen_survive)
+		{
+			counts = &result.survive;
+			seen_survive = true;
+		}
+		else
+		{
+			throw "rule must look like B3/S23";
+		}
+
+		for (++c; *c >= '0' && *c <= '8'; ++c)
+		{
+			*counts = static_cast<uint16_t>(*counts | (1 << (*c - '0')));
+		}
+
+		if (half == 0)
+		{
+			if (*c != '/')
+			{
+				throw "rule must look like B3/S23";
+			}
+			++c;
+		}
+	}
+
+	if (*c != 0)
+	{
+		throw "rule must look like B3/S23";
+	}
+
+	CheckRule(result);
+	return result;
+}
+
+/******************************************************************************/
+/*!
+Writes a rule with the birth counts first
+
+\param rule
+Rule to write
+
+\return
+The rule as text, such as "B3/S23"
+*/
+/******************************************************************************/
+std::string FormatRule(Rule const& rule)
+{
+	std::string result = "B";
+	for (int count = 0; count <= 8; ++count)
+	{
+		if (rule.birth & (1 << count))
+		{
+			result += static_cast<char>('0' + count);
+		}
+	}
+
+	result += "/S";
+	for (int count = 0; count <= 8; ++count)
+	{
+		if (rule.survive & (1 << count))
+		{
+			result += static_cast<char>('0' + count);
+		}
+	}
+
+	return result;
+}
@@ -0,0 +1,110 @@
+/******************************************************************************/
+/*!
+\file   rule.h
+\author Isaac Hill
+\par    email: Isaac.Hill@digipen.edu
+\par    DigiPen login: Isaac.Hill
+\par    Course: CS355
+\par    Assignment #1
+\date   1/21/2020
+\brief
+This is the Header file for turning a B/S rule into kernels. The kernels are
+templates on the rule, the common rules get their own compiled copy and any
+other rule runs the copy that reads the rule at run time.
+*/
+/******************************************************************************/
+
+#ifndef RULE_H
+#define RULE_H
+
+#include "gol.h"
+
+#include <cstdint>
+#include <string>
+
+// Bits 0-8 are the birth counts and bits 9-17 the survival counts, so the next
+// state of a cell with n live neighbors is bit n + 9 * alive
+inline uint32_t RuleBits(Rule const& rule)
+{
+	return (rule.birth & 0x1ffu) | (static_cast<uint32_t>(rule.survive & 0x1ffu) << 9);
+}
+
+// Writes a rule as "B36/S23", the form ParseRule reads
+std::string FormatRule(Rule const& rule);
+
+uint32_t const kLifeBits = (1u << 3) | ((1u << 2 | 1u << 3) << 9);                                  // B3/S23
+uint32_t const kHighLifeBits = (1u << 3 | 1u << 6) | ((1u << 2 | 1u << 3) << 9);                    // B36/S23
+uint32_t const kDayNightBits = (1u << 3 | 1u << 6 | 1u << 7 | 1u << 8) |
+                               ((1u << 3 | 1u << 4 | 1u << 6 | 1u << 7 | 1u << 8) << 9);            // B3678/S34678
+uint32_t const kSeedsBits = 1u << 2;                                                                // B2/S
+uint32_t const kAnyRule = 0xffffffffu; // the kernel reads the rule passed at run time
+
+/******************************************************************************/
+/*!
+Refuses rules the engines cannot run. With B0 the dead space around the board
+would come alive, which no engine models.
+
+\param rule
+Rule to check
+*/
+/******************************************************************************/
+inline void CheckRule(Rule const& rule)
+{
+	if (rule.birth & 1)
+	{
+		throw "rules with B0 are not supported";
+	}
+}
+
+/******************************************************************************/
+/*!
+Rule a kernel instance works with
+
+\param rule
+Bits passed at run time
+
+\return
+The bits the kernel was compiled for, or rule for the run time instance
+*/
+/******************************************************************************/
+template <uint32_t kBits>
+inline uint32_t SelectRule(uint32_t rule)
+{
+	return kBits == kAnyRule ? rule : kBits;
+}
+
+/******************************************************************************/
+/*!
+Calls Kernel<bits>::Run(bits, args...) with the compiled instance of the rule,
+or the run time one if the rule has none. Picked once per call, so the loops
+inside the kernel never look at the rule.
+
+\param rule
+Bits of the rule
+
+\param args
+Passed on to Run
+
+\return
+What Run returns
+*/
+/******************************************************************************/
+template <template <uint32_t> class Kernel, typename... Args>
+auto DispatchRule(uint32_t rule, Args&&... args) -> decltype(Kernel<kAnyRule>::Run(rule, args...))
+{
+	switch (rule)
+	{
+	case kLifeBits:
+		return Kernel<kLifeBits>::Run(rule, args...);
+	case kHighLifeBits:
+		return Kernel<kHighLifeBits>::Run(rule, args...);
+	case kDayNightBits:
+		return Kernel<kDayNightBits>::Run(rule, args...);
+	case kSeedsBits:
+		return Kernel<kSeedsBits>::Run(rule, args...);
+	default:
+		return Kernel<kAnyRule>::Run(rule, args...);
+	}
+}
+
+#endif
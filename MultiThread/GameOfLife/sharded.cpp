@@ -0,0 +1,594 @@
+/******************************************************************************/
+/*!
+\file   sharded.cpp
+\author Isaac Hill
+\par    email: Isaac.Hill@digipen.edu
+\par    DigiPen login: Isaac.Hill
+\par    Course: CS355
+\par    Assignment #1
+\date   1/21/2020
+\brief
+This is the Implementation file for the sharded game of life engine. The
+rows are split into bands and each band is stepped by its own forked
+process, so no process holds more than its band while the board runs.
+Neighboring bands swap their edge rows over Unix domain sockets every
+generation, the coordinator only sends commands and gathers the board when
+it is asked for.
+*/
+/******************************************************************************/
+
+#include "bitboard.h"
+#include "simulation.h"
+#include "pool.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace
+{
+	// Commands the coordinator sends to a shard
+	enum Command : int32_t
+	{
+		kAdvance, // step arg generations, reply when done
+		kGather,  // send every row of the band
+		kQuit     // exit
+	};
+
+	struct Message
+	{
+		int32_t command;
+		int32_t arg;
+	};
+
+	/******************************************************************************/
+	/*!
+	Writes a whole buffer to a socket
+
+	\param fd
+	Socket to write
+
+	\param data, size
+	Bytes to send
+
+	\return
+	False if the other end is gone
+	*/
+	/******************************************************************************/
+	bool SendAll(int fd, void const* data, size_t size)
+	{
+		char const* p = static_cast<char const*>(data);
+		while (size > 0)
+		{
+			//No SIGPIPE if the other process died, the caller sees the error instead
+			ssize_t const sent = send(fd, p, size, MSG_NOSIGNAL);
+			if (sent < 0 && errno == EINTR)
+			{
+				continue;
+			}
+			if (sent <= 0)
+			{
+				return false;
+			}
+
+			p += sent;
+			size -= sent;
+		}
+
+		return true;
+	}
+
+	/******************************************************************************/
+	/*!
+	Reads a whole buffer from a socket
+
+	\param fd
+	Socket to read
+
+	\param data, size
+	Receives the bytes
+
+	\return
+	False if the other end is gone
+	*/
+	/******************************************************************************/
+	bool ReceiveAll(int fd, void* data, size_t size)
+	{
+		char* p = static_cast<char*>(data);
+		while (size > 0)
+		{
+			ssize_t const got = recv(fd, p, size, 0);
+			if (got < 0 && errno == EINTR)
+			{
+				continue;
+			}
+			if (got <= 0)
+			{
+				return false;
+			}
+
+			p += got;
+			size -= got;
+		}
+
+		return true;
+	}
+
+	/******************************************************************************/
+	/*!
+	One band of rows in a shard process. Row 0 and the last row of the local
+	boards are halos holding the neighbors' edge rows, they stay dead at the
+	top and bottom of the board. On a torus the shards form a ring and the
+	first and last shard swap rows like any other neighbors.
+	*/
+	/******************************************************************************/
+	class Shard
+	{
+	public:
+		Shard(BoardView const& initial, Tile const& band, Options const& options, int control, int up, int down);
+
+		void Serve();
+
+	private:
+		bool ExchangeHalos();
+		bool Advance(int generations);
+		bool Gather();
+
+		BitBoard boards_[2];
+		int current_;
+		int rows_;
+		Rule rule_;
+		bool wrap_;
+		bool first_;  // band holds the top row of the board
+		bool last_;   // band holds the bottom row of the board
+		int control_; // socket to the coordinator
+		int up_;      // socket to the band above, -1 for the first band unless it wraps
+		int down_;    // socket to the band below, -1 for the last band unless it wraps
+	};
+
+	/******************************************************************************/
+	/*!
+	Copies the band out of the starting board
+
+	\param initial
+	Board to start from, the process's copy made by fork
+
+	\param band
+	Rows this shard owns
+
+	\param options
+	Rule and boundary to step with
+
+	\param control, up, down
+	Sockets to the coordinator and the neighboring shards
+	*/
+	/******************************************************************************/
+	Shard::Shard(BoardView const& initial, Tile const& band, Options const& options, int control, int up, int down)
+		: current_(0), rows_(band.y1 - band.y0), rule_(options.rule), wrap_(options.boundary == Boundary::kWrap),
+		  first_(band.y0 == 0), last_(band.y1 == initial.Height()), control_(control), up_(up), down_(down)
+	{
+		boards_[0] = CreateBitBoard(initial.Width(), rows_ + 2);
+		boards_[1] = CreateBitBoard(initial.Width(), rows_ + 2);
+
+		BitBoard& board = boards_[0];
+		int const y0 = band.y0;
+		int const y1 = band.y1;
+		initial.ForEachLive([&board, y0, y1](int x, int y)
+		{
+			if (y >= y0 && y < y1)
+			{
+				board.Row(y - y0 + 1)[x / 64] |= uint64_t(1) << (x % 64);
+			}
+		});
+	}
+
+	/******************************************************************************/
+	/*!
+	Runs commands from the coordinator until told to quit or it goes away
+	*/
+	/******************************************************************************/
+	void Shard::Serve()
+	{
+		Message message;
+		while (ReceiveAll(control_, &message, sizeof(message)))
+		{
+			bool ok = true;
+			if (message.command == kAdvance)
+			{
+				ok = Advance(message.arg);
+			}
+			else if (message.command == kGather)
+			{
+				ok = Gather();
+			}
+			else
+			{
+				break;
+			}
+
+			if (!ok)
+			{
+				break;
+			}
+		}
+	}
+
+	/******************************************************************************/
+	/*!
+	Sends the edge rows to the neighbors and receives theirs into the halos.
+	Every shard but the first sends down before it reads from above, so the
+	first shard, which reads first, always lets the chain or the ring drain
+	even when a row is larger than the socket buffer. The same is then done
+	going up with the last shard reading first. A lone shard on a torus is its
+	own neighbor and just copies the rows.
+
+	\return
+	False if a neighbor is gone
+	*/
+	/******************************************************************************/
+	bool Shard::ExchangeHalos()
+	{
+		BitBoard& board = boards_[current_];
+		size_t const row_bytes = board.words * sizeof(uint64_t);
+
+		if (wrap_ && first_ && last_)
+		{
+			std::copy(board.Row(rows_), board.Row(rows_) + board.words, board.Row(0));
+			std::copy(board.Row(1), board.Row(1) + board.words, board.Row(rows_ + 1));
+		}
+
+		if (!first_ && down_ >= 0 && !SendAll(down_, board.Row(rows_), row_bytes))
+		{
+			return false;
+		}
+		if (up_ >= 0 && !ReceiveAll(up_, board.Row(0), row_bytes))
+		{
+			return false;
+		}
+		if (first_ && down_ >= 0 && !SendAll(down_, board.Row(rows_), row_bytes))
+		{
+			return false;
+		}
+
+		if (!last_ && up_ >= 0 && !SendAll(up_, board.Row(1), row_bytes))
+		{
+			return false;
+		}
+		if (down_ >= 0 && !ReceiveAll(down_, board.Row(rows_ + 1), row_bytes))
+		{
+			return false;
+		}
+		if (last_ && up_ >= 0 && !SendAll(up_, board.Row(1), row_bytes))
+		{
+			return false;
+		}
+
+		//The halos came in without the cells past the side edges
+		if (wrap_)
+		{
+			WrapColumns(&board, 0, rows_ + 2);
+		}
+
+		return true;
+	}
+
+	/******************************************************************************/
+	/*!
+	Steps the band, swapping halos before every generation
+
+	\param generations
+	Number of generations to step
+
+	\return
+	False if a neighbor or the coordinator is gone
+	*/
+	/******************************************************************************/
+	bool Shard::Advance(int generations)
+	{
+		for (int i = 0; i < generations; ++i)
+		{
+			if (!ExchangeHalos())
+			{
+				return false;
+			}
+
+			StepRows(boards_[current_], &boards_[1 - current_], 1, rows_ + 1, rule_);
+			current_ = 1 - current_;
+		}
+
+		int32_t const done = 0;
+		return SendAll(control_, &done, sizeof(done));
+	}
+
+	/******************************************************************************/
+	/*!
+	Sends the rows of the band to the coordinator, halos left out
+
+	\return
+	False if the coordinator is gone
+	*/
+	/******************************************************************************/
+	bool Shard::Gather()
+	{
+		BitBoard const& board = boards_[current_];
+		for (int y = 1; y <= rows_; ++y)
+		{
+			if (!SendAll(control_, board.Row(y), board.words * sizeof(uint64_t)))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	/******************************************************************************/
+	/*!
+	Coordinator of the shard processes. It keeps no board while stepping, the
+	whole board is only pulled together when it is read.
+	*/
+	/******************************************************************************/
+	class ShardedSimulation : public Simulation
+	{
+	public:
+		ShardedSimulation(BoardView const& initial, Options const& options);
+		~ShardedSimulation();
+
+		void Advance(int generations);
+		std::vector< std::tuple<int, int> > Result() const { return GetResult(Gathered()); }
+		uint64_t Hash() const { return HashBoard(Gathered()); }
+		bool Alive(int x, int y) const { return (Gathered().Row(y)[x / 64] >> (x % 64)) & 1; }
+		void ForEachLive(std::function<void(int, int)> const& visit) const { ::ForEachLive(Gathered(), visit); }
+
+	private:
+		ShardedSimulation(ShardedSimulation const&);
+		ShardedSimulation& operator=(ShardedSimulation const&);
+
+		BitBoard const& Gathered() const;
+		void Stop();
+
+		std::vector<Tile> bands_;
+		std::vector<int> control_; // coordinator's end of each shard's socket
+		std::vector<pid_t> pids_;
+		mutable BitBoard board_;   // last gathered board
+		mutable bool gathered_;    // board_ matches the shards
+	};
+
+	/******************************************************************************/
+	/*!
+	Splits the rows into bands and forks one shard process per band
+
+	\param initial
+	Board to start from
+
+	\param options
+	Number of shards, rule and boundary to use
+	*/
+	/******************************************************************************/
+	ShardedSimulation::ShardedSimulation(BoardView const& initial, Options const& options)
+		: Simulation(initial.Width(), initial.Height()),
+		  bands_(SplitBands(initial.Width(), initial.Height(), options.num_shards > 0 ? options.num_shards : WorkerPool::DefaultSize())),
+		  gathered_(false)
+	{
+		int const num_shards = static_cast<int>(bands_.size());
+
+		//Socket i links the coordinator and shard i, halo i links shard i and shard i + 1,
+		//on a torus the last halo links the last shard and the first one
+		std::vector<int> shard_ends(num_shards, -1);
+		std::vector<int> halo_up(num_shards, -1);   // shard i's end of the link to shard i - 1
+		std::vector<int> halo_down(num_shards, -1); // shard i's end of the link to shard i + 1
+		control_.assign(num_shards, -1);
+
+		bool ok = true;
+		for (int i = 0; ok && i < num_shards; ++i)
+		{
+			int fds[2];
+			ok = socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0;
+			if (ok)
+			{
+				control_[i] = fds[0];
+				shard_ends[i] = fds[1];
+			}
+
+			if (ok && (i + 1 < num_shards || (options.boundary == Boundary::kWrap && num_shards > 1)))
+			{
+				ok = socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0;
+				if (ok)
+				{
+					halo_down[i] = fds[0];
+					halo_up[(i + 1) % num_shards] = fds[1];
+				}
+			}
+		}
+
+		for (int i = 0; ok && i < num_shards; ++i)
+		{
+			pid_t const pid = fork();
+			if (pid < 0)
+			{
+				ok = false;
+				break;
+			}
+
+			if (pid == 0)
+			{
+				//Only keep this shard's own sockets
+				for (int j = 0; j < num_shards; ++j)
+				{
+					close(control_[j]);
+					if (j != i)
+					{
+						close(shard_ends[j]);
+						close(halo_up[j]);
+						close(halo_down[j]);
+					}
+				}
+
+				int status = 0;
+				try
+				{
+					Shard shard(initial, bands_[i], options, shard_ends[i], halo_up[i], halo_down[i]);
+					shard.Serve();
+				}
+				catch (...)
+				{
+					status = 1;
+				}
+
+				//Never return into the coordinator's code
+				_exit(status);
+			}
+
+			pids_.push_back(pid);
+		}
+
+		for (int i = 0; i < num_shards; ++i)
+		{
+			close(shard_ends[i]);
+			close(halo_up[i]);
+			close(halo_down[i]);
+		}
+
+		if (!ok)
+		{
+			Stop();
+			throw "cannot start shard processes";
+		}
+	}
+
+	/******************************************************************************/
+	/*!
+	Tells the shards to quit and waits for them
+	*/
+	/******************************************************************************/
+	ShardedSimulation::~ShardedSimulation()
+	{
+		Stop();
+	}
+
+	/******************************************************************************/
+	/*!
+	Sends quit to every shard, closes the sockets and reaps the processes
+	*/
+	/******************************************************************************/
+	void ShardedSimulation::Stop()
+	{
+		Message const quit = { kQuit, 0 };
+		for (unsigned i = 0; i < control_.size(); ++i)
+		{
+			if (control_[i] >= 0)
+			{
+				SendAll(control_[i], &quit, sizeof(quit));
+				close(control_[i]);
+				control_[i] = -1;
+			}
+		}
+
+		for (unsigned i = 0; i < pids_.size(); ++i)
+		{
+			int status;
+			while (waitpid(pids_[i], &status, 0) < 0 && errno == EINTR)
+			{
+			}
+		}
+		pids_.clear();
+	}
+
+	/******************************************************************************/
+	/*!
+	Steps every shard and waits until all of them are done
+
+	\param generations
+	Number of generations to step
+	*/
+	/******************************************************************************/
+	void ShardedSimulation::Advance(int generations)
+	{
+		if (generations <= 0 || bands_.empty())
+		{
+			return;
+		}
+
+		gathered_ = false;
+
+		Message const message = { kAdvance, generations };
+		for (unsigned i = 0; i < control_.size(); ++i)
+		{
+			if (!SendAll(control_[i], &message, sizeof(message)))
+			{
+				throw "shard process failed";
+			}
+		}
+
+		for (unsigned i = 0; i < control_.size(); ++i)
+		{
+			int32_t done;
+			if (!ReceiveAll(control_[i], &done, sizeof(done)))
+			{
+				throw "shard process failed";
+			}
+		}
+	}
+
+	/******************************************************************************/
+	/*!
+	Pulls every band from the shards unless nothing moved since the last time
+
+	\return
+	The whole board in the current generation
+	*/
+	/******************************************************************************/
+	BitBoard const& ShardedSimulation::Gathered() const
+	{
+		if (gathered_)
+		{
+			return board_;
+		}
+
+		if (board_.cells.empty())
+		{
+			board_ = CreateBitBoard(Width(), Height());
+		}
+
+		Message const message = { kGather, 0 };
+		for (unsigned i = 0; i < control_.size(); ++i)
+		{
+			if (!SendAll(control_[i], &message, sizeof(message)))
+			{
+				throw "shard process failed";
+			}
+
+			for (int y = bands_[i].y0; y < bands_[i].y1; ++y)
+			{
+				if (!ReceiveAll(control_[i], board_.Row(y), board_.words * sizeof(uint64_t)))
+				{
+					throw "shard process failed";
+				}
+			}
+		}
+
+		gathered_ = true;
+		return board_;
+	}
+}
+
+/******************************************************************************/
+/*!
+Creates the sharded engine
+
+\param initial
+Board to start from
+
+\param options
+Number of shard processes to use
+
+\return
+Newly allocated simulation, owned by the caller
+*/
+/******************************************************************************/
+Simulation* CreateShardedSimulation(BoardView const& initial, Options const& options)
+{
+	return new ShardedSimulation(initial, options);
+}
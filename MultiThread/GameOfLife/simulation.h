@@ -0,0 +1,111 @@
+/******************************************************************************/
+/*!
+\file   simulation.h
+\author Isaac Hill
+\par    email: Isaac.Hill@digipen.edu
+\par    DigiPen login: Isaac.Hill
+\par    Course: CS355
+\par    Assignment #1
+\date   1/21/2020
+\brief
+This is the Header file for the interface every pooled game of life engine
+implements, plus the factories run uses to pick one
+*/
+/******************************************************************************/
+
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include "gol.h"
+#include "trace.h"
+
+#include <cstdint>
+#include <vector>
+#include <tuple>
+
+class Bitmap;
+struct RunProgress;
+
+/******************************************************************************/
+/*!
+A board that can be stepped any number of generations at a time
+*/
+/******************************************************************************/
+class Simulation : public BoardView
+{
+public:
+	Simulation(int width, int height) : BoardView(width, height) {}
+	virtual ~Simulation() {}
+
+	// Steps the board forward the given number of generations
+	virtual void Advance(int generations) = 0;
+
+	// Coordinates of all live cells in the current generation
+	virtual std::vector< std::tuple<int, int> > Result() const = 0;
+
+	// Engine specific statistics, most engines have none
+	virtual void GetStats(Stats* /*stats*/) const {}
+
+	// Hash of the current generation, equal boards give equal hashes
+	virtual uint64_t Hash() const;
+
+	// Visits the cells of Result, engines that can scan their own storage override it
+	virtual void ForEachLive(std::function<void(int, int)> const& visit) const;
+
+	// Points view at the current generation if the engine keeps it bit packed,
+	// valid until the next Advance, false if the engine stores it another way
+	virtual bool GetBitmap(Bitmap* /*view*/) const { return false; }
+
+	// Phases recorded by the workers, empty unless built with GOL_TRACE
+	Tracer const& GetTracer() const { return tracer_; }
+
+protected:
+	Tracer tracer_;
+};
+
+/******************************************************************************/
+/*!
+Mixes one more word into a running hash
+
+\param hash
+Hash so far
+
+\param word
+Word to add
+
+\return
+New hash
+*/
+/******************************************************************************/
+inline uint64_t HashWord(uint64_t hash, uint64_t word)
+{
+	hash = (hash ^ word) * 0x9e3779b97f4a7c15ULL;
+	return hash ^ (hash >> 32);
+}
+
+// Rectangle of cells [x0,x1) x [y0,y1) owned by one worker
+struct Tile
+{
+	int x0, x1;
+	int y0, y1;
+};
+
+std::vector<Tile> SplitTiles(int max_x, int max_y, int num_tiles);
+std::vector<Tile> SplitBands(int max_x, int max_y, int num_bands);
+
+Stats AdvanceDetectingCycles(Simulation* simulation, int num_iter, int history);
+Stats AdvanceObserved(Simulation* simulation, int num_iter, Options const& options);
+Stats AdvanceCheckpointed(Simulation* simulation, long long first_generation, int num_iter, Options const& options);
+Stats AdvanceCancellable(Simulation* simulation, int num_iter, RunProgress* progress);
+
+Simulation* CreateSimulation(BoardView const& initial, Options const& options);
+Simulation* CreateTiledSimulation(BoardView const& initial, Options const& options);
+Simulation* CreateBitSimulation(BoardView const& initial, Options const& options);
+Simulation* CreateSimdSimulation(BoardView const& initial, Options const& options);
+Simulation* CreateHashLifeSimulation(BoardView const& initial, Options const& options);
+Simulation* CreateActiveSimulation(BoardView const& initial, Options const& options);
+Simulation* CreateSparseSimulation(BoardView const& initial, Options const& options);
+Simulation* CreateShardedSimulation(BoardView const& initial, Options const& options);
+Simulation* CreateLookupSimulation(BoardView const& initial, Options const& options);
+
+#endif
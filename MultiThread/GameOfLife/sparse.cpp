@@ -0,0 +1,522 @@
+/******************************************************************************/
+/*!
+\file   sparse.cpp
+\author Isaac Hill
+\par    email: Isaac.Hill@digipen.edu
+\par    DigiPen login: Isaac.Hill
+\par    Course: CS355
+\par    Assignment #1
+\date   1/21/2020
+\brief
+This is the Implementation file for the sparse game of life engine, which
+only keeps the 64x64 chunks of the board that have live cells in them
+*/
+/******************************************************************************/
+
+#include "simulation.h"
+#include "bitboard.h"
+#include "pool.h"
+
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace
+{
+	int const kChunkBits = 6;
+	int const kChunkSize = 1 << kChunkBits;
+
+	// 64x64 cells, bit x of rows[y] is cell x of row y
+	struct Chunk
+	{
+		uint64_t rows[kChunkSize];
+	};
+
+	typedef std::unordered_map<int64_t, Chunk> ChunkMap;
+
+	/******************************************************************************/
+	/*!
+	Steps the rows of a chunk from its frame, compiled once per rule, see
+	DispatchRule
+
+	\param rule
+	Rule bits, only read by the kAnyRule instance
+
+	\param frame
+	Rows -1 to 64 of the west, own and east chunk
+
+	\param out
+	Receives the next generation of the chunk
+
+	\param rows
+	Rows of the chunk inside the board
+
+	\param mask
+	Columns of the chunk inside the board
+	*/
+	/******************************************************************************/
+	template <uint32_t kBits>
+	struct ChunkKernel
+	{
+		static void Run(uint32_t rule, uint64_t const (*frame)[3], Chunk* out, int rows, uint64_t mask)
+		{
+			for (int y = 0; y < rows; ++y)
+			{
+				uint64_t const* up = frame[y];
+				uint64_t const* mid = frame[y + 1];
+				uint64_t const* down = frame[y + 2];
+
+				uint64_t const up_w = (up[1] << 1) | (up[0] >> 63);
+				uint64_t const up_e = (up[1] >> 1) | (up[2] << 63);
+				uint64_t const mid_w = (mid[1] << 1) | (mid[0] >> 63);
+				uint64_t const mid_e = (mid[1] >> 1) | (mid[2] << 63);
+				uint64_t const down_w = (down[1] << 1) | (down[0] >> 63);
+				uint64_t const down_e = (down[1] >> 1) | (down[2] << 63);
+
+				out->rows[y] = StepWordRule<kBits>(rule, up_w, up[1], up_e, mid_w, mid[1], mid_e, down_w, down[1], down_e) & mask;
+			}
+		}
+	};
+
+	/******************************************************************************/
+	/*!
+	Packs chunk coordinates into a map key
+
+	\param cx, cy
+	Chunk coordinates, cell x / 64 and cell y / 64
+
+	\return
+	Key of the chunk
+	*/
+	/******************************************************************************/
+	int64_t ChunkKey(int cx, int cy)
+	{
+		return (static_cast<int64_t>(cy) << 32) | static_cast<uint32_t>(cx);
+	}
+
+	/******************************************************************************/
+	/*!
+	Board stored as a hash map of bit packed chunks. Chunks are created when a
+	neighbor could give birth into them and freed once they die out, so memory
+	and work follow the live area instead of the board size.
+	*/
+	/******************************************************************************/
+	class SparseSimulation : public Simulation
+	{
+	public:
+		SparseSimulation(BoardView const& initial, Options const& options);
+
+		void Advance(int generations);
+		std::vector< std::tuple<int, int> > Result() const;
+		bool Alive(int x, int y) const;
+		void ForEachLive(std::function<void(int, int)> const& visit) const;
+
+	private:
+		void StepChunk(int cx, int cy, Chunk* out) const;
+		void WrapFrame(int cx, int cy, uint64_t (*frame)[3]) const;
+		void AddCandidates(int cx, int cy, Chunk const& chunk, std::unordered_set<int64_t>* candidates) const;
+		Chunk const* Find(int cx, int cy) const;
+
+		ChunkMap chunks_;
+		int max_x_;
+		int max_y_;
+		int chunks_x_; // chunks needed to cover the board
+		int chunks_y_;
+		uint32_t rule_; // bits from RuleBits
+		bool wrap_;
+		WorkerPool pool_;
+
+		std::vector<int64_t> candidates_;
+		std::vector<Chunk> next_;
+	};
+
+	/******************************************************************************/
+	/*!
+	Creates a chunk for every live cell of the initial board
+
+	\param initial
+	Board to start from
+
+	\param options
+	Thread count, rule and boundary to use
+	*/
+	/******************************************************************************/
+	SparseSimulation::SparseSimulation(BoardView const& initial, Options const& options)
+		: Simulation(initial.Width(), initial.Height()),
+		  max_x_(initial.Width()), max_y_(initial.Height()),
+		  chunks_x_((max_x_ + kChunkSize - 1) >> kChunkBits),
+		  chunks_y_((max_y_ + kChunkSize - 1) >> kChunkBits),
+		  rule_(RuleBits(options.rule)),
+		  wrap_(options.boundary == Boundary::kWrap),
+		  pool_(options.num_threads, options.numa)
+	{
+		Chunk const empty = {};
+
+		initial.ForEachLive([this, &empty](int x, int y)
+		{
+			ChunkMap::iterator it = chunks_.insert(std::make_pair(ChunkKey(x >> kChunkBits, y >> kChunkBits), empty)).first;
+			it->second.rows[y & (kChunkSize - 1)] |= uint64_t(1) << (x & (kChunkSize - 1));
+		});
+	}
+
+	/******************************************************************************/
+	/*!
+	Looks up a chunk
+
+	\param cx, cy
+	Chunk coordinates
+
+	\return
+	The chunk, or 0 if it is empty
+	*/
+	/******************************************************************************/
+	Chunk const* SparseSimulation::Find(int cx, int cy) const
+	{
+		ChunkMap::const_iterator it = chunks_.find(ChunkKey(cx, cy));
+		return it == chunks_.end() ? 0 : &it->second;
+	}
+
+	/******************************************************************************/
+	/*!
+	Adds a chunk and every neighbor chunk that one of its edge cells could give
+	birth into. The last column and row of the board count as an edge even in
+	the middle of a chunk, on a torus they touch the chunks on the other side.
+
+	\param cx, cy
+	Chunk coordinates
+
+	\param chunk
+	Cells of the chunk
+
+	\param candidates
+	Set of chunks that have to be stepped
+	*/
+	/******************************************************************************/
+	void SparseSimulation::AddCandidates(int cx, int cy, Chunk const& chunk, std::unordered_set<int64_t>* candidates) const
+	{
+		int const x_end = max_x_ - (cx << kChunkBits);
+		int const y_end = max_y_ - (cy << kChunkBits);
+		int const bottom = y_end < kChunkSize ? y_end - 1 : kChunkSize - 1;
+		uint64_t const left = uint64_t(1);
+		uint64_t const right = uint64_t(1) << (x_end < kChunkSize ? x_end - 1 : kChunkSize - 1);
+
+		uint64_t columns = 0;
+		for (int y = 0; y < kChunkSize; ++y)
+		{
+			columns |= chunk.rows[y];
+		}
+
+		bool const north = chunk.rows[0] != 0;
+		bool const south = chunk.rows[bottom] != 0;
+		bool const west = (columns & left) != 0;
+		bool const east = (columns & right) != 0;
+
+		bool const edges[3][3] =
+		{
+			{ (chunk.rows[0] & left) != 0, north, (chunk.rows[0] & right) != 0 },
+			{ west, true, east },
+			{ (chunk.rows[bottom] & left) != 0, south, (chunk.rows[bottom] & right) != 0 }
+		};
+
+		for (int dy = -1; dy <= 1; ++dy)
+		{
+			for (int dx = -1; dx <= 1; ++dx)
+			{
+				int nx = cx + dx;
+				int ny = cy + dy;
+				if (wrap_)
+				{
+					nx = (nx + chunks_x_) % chunks_x_;
+					ny = (ny + chunks_y_) % chunks_y_;
+				}
+
+				if (edges[dy + 1][dx + 1] && nx >= 0 && ny >= 0 && nx < chunks_x_ && ny < chunks_y_)
+				{
+					candidates->insert(ChunkKey(nx, ny));
+				}
+			}
+		}
+	}
+
+	/******************************************************************************/
+	/*!
+	Steps one chunk, looking into the 8 chunks around it for the cells on its
+	edges
+
+	\param cx, cy
+	Chunk coordinates
+
+	\param out
+	Receives the next generation of the chunk
+	*/
+	/******************************************************************************/
+	void SparseSimulation::StepChunk(int cx, int cy, Chunk* out) const
+	{
+		//Rows -1 to 64 of the west, own and east chunk
+		uint64_t frame[kChunkSize + 2][3] = {};
+
+		if (wrap_)
+		{
+			WrapFrame(cx, cy, frame);
+		}
+		else
+		{
+			for (int dy = -1; dy <= 1; ++dy)
+			{
+				for (int dx = -1; dx <= 1; ++dx)
+				{
+					Chunk const* chunk = Find(cx + dx, cy + dy);
+					if (!chunk)
+					{
+						continue;
+					}
+
+					//Only the row next to this chunk is needed from above and below
+					int const first = dy == -1 ? kChunkSize - 1 : 0;
+					int const last = dy == 1 ? 0 : kChunkSize - 1;
+					for (int y = first; y <= last; ++y)
+					{
+						frame[y + 1 + dy * kChunkSize][dx + 1] = chunk->rows[y];
+					}
+				}
+			}
+		}
+
+		//Cells past the edge of the board must stay dead
+		int const x_end = max_x_ - (cx << kChunkBits);
+		int const y_end = max_y_ - (cy << kChunkBits);
+		uint64_t const mask = x_end >= kChunkSize ? ~uint64_t(0) : (uint64_t(1) << x_end) - 1;
+		int const rows = y_end >= kChunkSize ? kChunkSize : y_end;
+
+		DispatchRule<ChunkKernel>(rule_, frame, out, rows, mask);
+
+		for (int y = rows; y < kChunkSize; ++y)
+		{
+			out->rows[y] = 0;
+		}
+	}
+
+	/******************************************************************************/
+	/*!
+	Fills the frame of a chunk on a torus. The rows above and below the board
+	come from the other side, and so do the cells just past the first and last
+	column. A chunk cut short by the right edge takes the cell past its last
+	column in its own word, the kernel reads it from there and the mask drops
+	it again.
+
+	\param cx, cy
+	Chunk coordinates
+
+	\param frame
+	Rows -1 to 64 of the west, own and east chunk, all zero on entry
+	*/
+	/******************************************************************************/
+	void SparseSimulation::WrapFrame(int cx, int cy, uint64_t (*frame)[3]) const
+	{
+		int const x0 = cx << kChunkBits;
+		int const y0 = cy << kChunkBits;
+		int const x_end = max_x_ - x0 < kChunkSize ? max_x_ - x0 : kChunkSize;
+		int const y_end = max_y_ - y0 < kChunkSize ? max_y_ - y0 : kChunkSize;
+
+		//Cells just past the first and last column
+		int const west = x0 > 0 ? x0 - 1 : max_x_ - 1;
+		int const east = x0 + x_end < max_x_ ? x0 + x_end : 0;
+
+		//Rows come from at most three rows of chunks, each looked up once
+		int chunk_y = -1;
+		Chunk const* own = 0;
+		Chunk const* west_chunk = 0;
+		Chunk const* east_chunk = 0;
+
+		for (int fy = 0; fy < y_end + 2; ++fy)
+		{
+			int y = y0 + fy - 1;
+			if (y < 0)
+			{
+				y = max_y_ - 1;
+			}
+			else if (y >= max_y_)
+			{
+				y = 0;
+			}
+
+			if (y >> kChunkBits != chunk_y)
+			{
+				chunk_y = y >> kChunkBits;
+				own = Find(cx, chunk_y);
+				west_chunk = Find(west >> kChunkBits, chunk_y);
+				east_chunk = Find(east >> kChunkBits, chunk_y);
+			}
+
+			int const row = y & (kChunkSize - 1);
+			uint64_t const west_cell = west_chunk ? (west_chunk->rows[row] >> (west & (kChunkSize - 1))) & 1 : 0;
+			uint64_t const east_cell = east_chunk ? (east_chunk->rows[row] >> (east & (kChunkSize - 1))) & 1 : 0;
+
+			frame[fy][0] = west_cell << (kChunkSize - 1);
+			frame[fy][1] = own ? own->rows[row] : 0;
+			if (x_end < kChunkSize)
+			{
+				frame[fy][1] |= east_cell << x_end;
+			}
+			else
+			{
+				frame[fy][2] = east_cell;
+			}
+		}
+	}
+
+	/******************************************************************************/
+	/*!
+	Steps the board, the chunks to step are split between the workers and the
+	map is rebuilt from the ones that still have live cells
+
+	\param generations
+	Number of generations to step
+	*/
+	/******************************************************************************/
+	void SparseSimulation::Advance(int generations)
+	{
+		int const num_workers = pool_.Size();
+
+		for (int i = 0; i < generations && !chunks_.empty(); ++i)
+		{
+			std::unordered_set<int64_t> candidates;
+			for (ChunkMap::const_iterator it = chunks_.begin(); it != chunks_.end(); ++it)
+			{
+				int const cx = static_cast<int>(static_cast<uint32_t>(it->first));
+				int const cy = static_cast<int>(it->first >> 32);
+				AddCandidates(cx, cy, it->second, &candidates);
+			}
+
+			candidates_.assign(candidates.begin(), candidates.end());
+			next_.resize(candidates_.size());
+
+			pool_.Run([this, num_workers](int worker)
+			{
+				for (size_t j = worker; j < candidates_.size(); j += num_workers)
+				{
+					int const cx = static_cast<int>(static_cast<uint32_t>(candidates_[j]));
+					int const cy = static_cast<int>(candidates_[j] >> 32);
+					StepChunk(cx, cy, &next_[j]);
+				}
+			});
+
+			//Keep the chunks that are still alive, the rest are freed
+			ChunkMap chunks;
+			chunks.reserve(candidates_.size());
+			for (size_t j = 0; j < candidates_.size(); ++j)
+			{
+				Chunk const& chunk = next_[j];
+				uint64_t any = 0;
+				for (int y = 0; y < kChunkSize; ++y)
+				{
+					any |= chunk.rows[y];
+				}
+
+				if (any)
+				{
+					chunks.insert(std::make_pair(candidates_[j], chunk));
+				}
+			}
+			chunks_.swap(chunks);
+		}
+	}
+
+	/******************************************************************************/
+	/*!
+	Looks up one cell
+
+	\param x, y
+	Cell to look at
+
+	\return
+	If the cell is alive, cells of missing chunks are dead
+	*/
+	/******************************************************************************/
+	bool SparseSimulation::Alive(int x, int y) const
+	{
+		Chunk const* chunk = Find(x >> kChunkBits, y >> kChunkBits);
+		return chunk && ((chunk->rows[y & (kChunkSize - 1)] >> (x & (kChunkSize - 1))) & 1);
+	}
+
+	/******************************************************************************/
+	/*!
+	Visits every live cell, chunk by chunk
+
+	\param visit
+	Called with the coordinates of each live cell
+	*/
+	/******************************************************************************/
+	void SparseSimulation::ForEachLive(std::function<void(int, int)> const& visit) const
+	{
+		for (ChunkMap::const_iterator it = chunks_.begin(); it != chunks_.end(); ++it)
+		{
+			int const x0 = static_cast<int>(static_cast<uint32_t>(it->first)) << kChunkBits;
+			int const y0 = static_cast<int>(it->first >> 32) << kChunkBits;
+
+			for (int y = 0; y < kChunkSize; ++y)
+			{
+				uint64_t row = it->second.rows[y];
+				while (row)
+				{
+					visit(x0 + __builtin_ctzll(row), y0 + y);
+					row &= row - 1;
+				}
+			}
+		}
+	}
+
+	/******************************************************************************/
+	/*!
+	Gets coordinates of all live spaces on board, in the same order as the
+	nested vector version
+
+	\return
+	All coordinates of live spaces on board
+	*/
+	/******************************************************************************/
+	std::vector< std::tuple<int, int> > SparseSimulation::Result() const
+	{
+		std::vector< std::tuple<int, int> > result;
+
+		for (ChunkMap::const_iterator it = chunks_.begin(); it != chunks_.end(); ++it)
+		{
+			int const x0 = static_cast<int>(static_cast<uint32_t>(it->first)) << kChunkBits;
+			int const y0 = static_cast<int>(it->first >> 32) << kChunkBits;
+
+			for (int y = 0; y < kChunkSize; ++y)
+			{
+				uint64_t row = it->second.rows[y];
+				while (row)
+				{
+					int const x = __builtin_ctzll(row);
+					result.push_back(std::make_tuple(x0 + x, y0 + y));
+					row &= row - 1;
+				}
+			}
+		}
+
+		std::sort(result.begin(), result.end());
+
+		return result;
+	}
+}
+
+/******************************************************************************/
+/*!
+Creates the sparse chunked engine
+
+\param initial
+Board to start from
+
+\param options
+Thread count to use
+
+\return
+Newly allocated simulation, owned by the caller
+*/
+/******************************************************************************/
+Simulation* CreateSparseSimulation(BoardView const& initial, Options const& options)
+{
+	return new SparseSimulation(initial, options);
+}
@@ -0,0 +1,479 @@
+/******************************************************************************/
+/*!
+\file   tiled.cpp
+\author Isaac Hill
+\par    email: Isaac.Hill@digipen.edu
+\par    DigiPen login: Isaac.Hill
+\par    Course: CS355
+\par    Assignment #1
+\date   1/21/2020
+\brief
+This is the Implementation file for the tiled game of life engine, a fixed
+size worker pool where every worker owns one rectangular tile of the board
+*/
+/******************************************************************************/
+
+#include "simulation.h"
+#include "board.h"
+#include "grid.h"
+#include "rule.h"
+#include "pool.h"
+
+#include <cstring>
+
+namespace
+{
+	/******************************************************************************/
+	/*!
+	Copies cells from a row of a torus, starting anywhere and running around
+	the row as many times as needed
+
+	\param dest
+	Receives the cells
+
+	\param row
+	Row to copy from
+
+	\param width
+	Cells in the row
+
+	\param x
+	First cell to copy, can be negative or past the width
+
+	\param count
+	Cells to copy
+	*/
+	/******************************************************************************/
+	void CopyWrapped(uint8_t* dest, uint8_t const* row, int width, int x, int count)
+	{
+		x %= width;
+		if (x < 0)
+		{
+			x += width;
+		}
+
+		while (count > 0)
+		{
+			int const run = width - x < count ? width - x : count;
+			std::memcpy(dest, row + x, run);
+			dest += run;
+			count -= run;
+			x = 0;
+		}
+	}
+
+	/******************************************************************************/
+	/*!
+	In place it uses the same read then write scheme as Simulate, but each
+	worker steps a whole tile. Double buffered it steps two flat grids and only
+	needs the one barrier per generation. With temporal blocking each worker
+	copies its tile plus a halo k cells wide into its own scratch grids, steps
+	them k generations and writes the tile back, one barrier per k generations.
+	*/
+	/******************************************************************************/
+	class TiledSimulation : public Simulation
+	{
+	public:
+		TiledSimulation(BoardView const& initial, Options const& options);
+
+		void Advance(int generations);
+		std::vector< std::tuple<int, int> > Result() const;
+		uint64_t Hash() const;
+		bool Alive(int x, int y) const;
+		void ForEachLive(std::function<void(int, int)> const& visit) const;
+
+	private:
+		void StepInPlace(int worker, int generations);
+		void StepDoubleBuffered(int worker, int generations);
+		void StepBlocked(int worker, int generations);
+
+		Buffering buffering_;
+		Rule rule_;
+		Boundary boundary_;
+		Board board_;
+		ByteGrid grids_[2];
+		int current_;
+		std::vector<Tile> tiles_;
+		std::vector<std::vector<State>> new_states_;
+		int temporal_block_;
+		std::vector<ByteGrid> scratch_; // two per worker for temporal blocking
+		WorkerPool pool_;
+		Barrier barrier_;
+	};
+
+	/******************************************************************************/
+	/*!
+	Creates the board and splits it into one tile per worker
+
+	\param initial
+	Board to start from
+
+	\param options
+	Thread count, buffering, rule and boundary to use
+	*/
+	/******************************************************************************/
+	TiledSimulation::TiledSimulation(BoardView const& initial, Options const& options)
+		: Simulation(initial.Width(), initial.Height()),
+		  buffering_(options.buffering),
+		  rule_(options.rule),
+		  boundary_(options.boundary),
+		  current_(0),
+		  tiles_(SplitTiles(initial.Width(), initial.Height(), options.num_threads > 0 ? options.num_threads : WorkerPool::DefaultSize())),
+		  new_states_(tiles_.size()),
+		  temporal_block_(options.temporal_block > 1 ? options.temporal_block : 1),
+		  pool_(static_cast<int>(tiles_.size()), options.numa),
+		  barrier_(static_cast<int>(tiles_.size()), options.barrier)
+	{
+		tracer_.Start(pool_.Size());
+
+		if (buffering_ == Buffering::kDoubleBuffered)
+		{
+			grids_[0] = CreateByteGrid(initial);
+			grids_[1] = ByteGrid(initial.Width(), initial.Height());
+			scratch_.resize(temporal_block_ > 1 ? 2 * tiles_.size() : 0);
+			if (boundary_ == Boundary::kWrap)
+			{
+				WrapBorder(&grids_[0], 0, initial.Width(), 0, initial.Height());
+			}
+			return;
+		}
+
+		board_ = CreateBoard(initial);
+		if (boundary_ == Boundary::kWrap)
+		{
+			WrapBorder(&board_, 0, initial.Width(), 0, initial.Height());
+		}
+		for (unsigned i = 0; i < tiles_.size(); ++i)
+		{
+			Tile const& tile = tiles_[i];
+			new_states_[i].resize((tile.x1 - tile.x0) * (tile.y1 - tile.y0));
+		}
+	}
+
+	/******************************************************************************/
+	/*!
+	Steps the board on every worker
+
+	\param generations
+	Number of generations to step
+	*/
+	/******************************************************************************/
+	void TiledSimulation::Advance(int generations)
+	{
+		if (generations <= 0 || tiles_.empty())
+		{
+			return;
+		}
+
+		if (buffering_ == Buffering::kDoubleBuffered && temporal_block_ > 1)
+		{
+			//The grids are only swapped once per block
+			pool_.Run([this, generations](int worker) { StepBlocked(worker, generations); });
+			current_ = (current_ + (generations + temporal_block_ - 1) / temporal_block_) % 2;
+		}
+		else if (buffering_ == Buffering::kDoubleBuffered)
+		{
+			pool_.Run([this, generations](int worker) { StepDoubleBuffered(worker, generations); });
+			current_ = (current_ + generations) % 2;
+		}
+		else
+		{
+			pool_.Run([this, generations](int worker) { StepInPlace(worker, generations); });
+		}
+	}
+
+	/******************************************************************************/
+	/*!
+	Main logic for one worker, reads its whole tile then writes it back
+
+	\param worker
+	Index of the worker and of the tile it owns
+
+	\param generations
+	Number of generations to step
+	*/
+	/******************************************************************************/
+	void TiledSimulation::StepInPlace(int worker, int generations)
+	{
+		Tile const tile = tiles_[worker];
+		std::vector<State>& new_states = new_states_[worker];
+		bool const life = RuleBits(rule_) == kLifeBits;
+
+		for (int i = 0; i < generations; ++i)
+		{
+			// Look at neighbors and find out fate of every cell in the tile
+			{
+				GOL_TRACE_PHASE(&tracer_, worker, Phase::kCompute, i);
+				int k = 0;
+				for (int x = tile.x0 + 1; x <= tile.x1; ++x)
+				{
+					for (int y = tile.y0 + 1; y <= tile.y1; ++y)
+					{
+						new_states[k++] = life ? CalculateNewState(&board_, x, y) : CalculateNewState(&board_, x, y, rule_);
+					}
+				}
+			}
+
+			{
+				GOL_TRACE_PHASE(&tracer_, worker, Phase::kBarrier, i);
+				barrier_.Wait(worker);
+			}
+
+			//Write new states to board
+			{
+				GOL_TRACE_PHASE(&tracer_, worker, Phase::kWriteBack, i);
+				int k = 0;
+				for (int x = tile.x0 + 1; x <= tile.x1; ++x)
+				{
+					for (int y = tile.y0 + 1; y <= tile.y1; ++y)
+					{
+						board_[x][y] = new_states[k++];
+					}
+				}
+				if (boundary_ == Boundary::kWrap)
+				{
+					WrapBorder(&board_, tile.x0, tile.x1, tile.y0, tile.y1);
+				}
+			}
+
+			{
+				GOL_TRACE_PHASE(&tracer_, worker, Phase::kBarrier, i);
+				barrier_.Wait(worker);
+			}
+		}
+	}
+
+	/******************************************************************************/
+	/*!
+	Main logic for one worker when double buffered, nobody writes the grid that
+	is being read so one barrier per generation is enough
+
+	\param worker
+	Index of the worker and of the tile it owns
+
+	\param generations
+	Number of generations to step
+	*/
+	/******************************************************************************/
+	void TiledSimulation::StepDoubleBuffered(int worker, int generations)
+	{
+		Tile const tile = tiles_[worker];
+		int current = current_;
+
+		for (int i = 0; i < generations; ++i)
+		{
+			{
+				GOL_TRACE_PHASE(&tracer_, worker, Phase::kCompute, i);
+				StepGridRect(grids_[current], &grids_[1 - current], tile.x0, tile.x1, tile.y0, tile.y1, rule_);
+				if (boundary_ == Boundary::kWrap)
+				{
+					WrapBorder(&grids_[1 - current], tile.x0, tile.x1, tile.y0, tile.y1);
+				}
+			}
+			current = 1 - current;
+
+			{
+				GOL_TRACE_PHASE(&tracer_, worker, Phase::kBarrier, i);
+				barrier_.Wait(worker);
+			}
+		}
+	}
+
+	/******************************************************************************/
+	/*!
+	Main logic for one worker with temporal blocking. The scratch grids only
+	cover the part of the halo inside the board, so their dead padding is the
+	board border where the halo meets the edge. Where the halo was cut short
+	the padding is wrong, but the error only moves in one cell per generation
+	and never reaches the tile within k generations. On a torus the halo is not
+	clipped, it is copied from the other side of the board instead.
+
+	\param worker
+	Index of the worker and of the tile it owns
+
+	\param generations
+	Number of generations to step
+	*/
+	/******************************************************************************/
+	void TiledSimulation::StepBlocked(int worker, int generations)
+	{
+		Tile const tile = tiles_[worker];
+		int const width = grids_[0].Width();
+		int const height = grids_[0].Height();
+		int const k = temporal_block_;
+
+		//Tile plus halo, clipped to the board unless it wraps
+		bool const wrap = boundary_ == Boundary::kWrap;
+		int const x0 = tile.x0 - k > 0 || wrap ? tile.x0 - k : 0;
+		int const y0 = tile.y0 - k > 0 || wrap ? tile.y0 - k : 0;
+		int const x1 = tile.x1 + k < width || wrap ? tile.x1 + k : width;
+		int const y1 = tile.y1 + k < height || wrap ? tile.y1 + k : height;
+
+		//First touch of the scratch grids happens on the worker that uses them
+		ByteGrid* scratch = &scratch_[2 * worker];
+		if (scratch[0].Width() != x1 - x0 || scratch[0].Height() != y1 - y0)
+		{
+			scratch[0] = ByteGrid(x1 - x0, y1 - y0);
+			scratch[1] = ByteGrid(x1 - x0, y1 - y0);
+		}
+
+		int current = current_;
+
+		for (int done = 0; done < generations; done += k)
+		{
+			int const steps = generations - done < k ? generations - done : k;
+
+			int local = 0;
+			{
+				GOL_TRACE_PHASE(&tracer_, worker, Phase::kCompute, done);
+				for (int y = y0; y < y1; ++y)
+				{
+					if (wrap)
+					{
+						int const row = (y % height + height) % height;
+						CopyWrapped(scratch[0].Row(y - y0), grids_[current].Row(row), width, x0, x1 - x0);
+					}
+					else
+					{
+						std::memcpy(scratch[0].Row(y - y0), grids_[current].Row(y) + x0, x1 - x0);
+					}
+				}
+
+				for (int i = 0; i < steps; ++i)
+				{
+					StepGridRows(scratch[local], &scratch[1 - local], 0, y1 - y0, rule_);
+					local = 1 - local;
+				}
+			}
+
+			{
+				GOL_TRACE_PHASE(&tracer_, worker, Phase::kWriteBack, done);
+				for (int y = tile.y0; y < tile.y1; ++y)
+				{
+					std::memcpy(grids_[1 - current].Row(y) + tile.x0, scratch[local].Row(y - y0) + tile.x0 - x0, tile.x1 - tile.x0);
+				}
+			}
+
+			current = 1 - current;
+
+			{
+				GOL_TRACE_PHASE(&tracer_, worker, Phase::kBarrier, done);
+				barrier_.Wait(worker);
+			}
+		}
+	}
+
+	/******************************************************************************/
+	/*!
+	Gets coordinates of all live spaces on board
+
+	\return
+	All coordinates of live spaces on board
+	*/
+	/******************************************************************************/
+	std::vector< std::tuple<int, int> > TiledSimulation::Result() const
+	{
+		if (buffering_ == Buffering::kDoubleBuffered)
+		{
+			return GetResult(grids_[current_]);
+		}
+
+		return GetResult(board_);
+	}
+
+	/******************************************************************************/
+	/*!
+	Looks up one cell of the current generation
+
+	\param x, y
+	Cell to look at
+
+	\return
+	If the cell is alive
+	*/
+	/******************************************************************************/
+	bool TiledSimulation::Alive(int x, int y) const
+	{
+		if (buffering_ == Buffering::kDoubleBuffered)
+		{
+			return grids_[current_].Row(y)[x] != 0;
+		}
+
+		//board_ has a dead border, cell (x, y) is at [x + 1][y + 1]
+		return board_[x + 1][y + 1] == kAlive;
+	}
+
+	/******************************************************************************/
+	/*!
+	Visits every live cell of the current generation
+
+	\param visit
+	Called with the coordinates of each live cell
+	*/
+	/******************************************************************************/
+	void TiledSimulation::ForEachLive(std::function<void(int, int)> const& visit) const
+	{
+		if (buffering_ == Buffering::kDoubleBuffered)
+		{
+			::ForEachLive(grids_[current_], visit);
+			return;
+		}
+
+		for (unsigned x = 1; x + 1 < board_.size(); ++x)
+		{
+			for (unsigned y = 1; y + 1 < board_[x].size(); ++y)
+			{
+				if (board_[x][y] == kAlive)
+				{
+					visit(x - 1, y - 1);
+				}
+			}
+		}
+	}
+
+	/******************************************************************************/
+	/*!
+	Hash of the current generation
+
+	\return
+	Hash of the cells
+	*/
+	/******************************************************************************/
+	uint64_t TiledSimulation::Hash() const
+	{
+		if (buffering_ == Buffering::kDoubleBuffered)
+		{
+			return HashBoard(grids_[current_]);
+		}
+
+		uint64_t hash = 0;
+		for (unsigned x = 1; x + 1 < board_.size(); ++x)
+		{
+			for (unsigned y = 1; y + 1 < board_[x].size(); ++y)
+			{
+				hash = HashWord(hash, board_[x][y]);
+			}
+		}
+
+		return hash;
+	}
+}
+
+/******************************************************************************/
+/*!
+Creates the tiled engine
+
+\param initial
+Board to start from
+
+\param options
+Thread count to use
+
+\return
+Newly allocated simulation, owned by the caller
+*/
+/******************************************************************************/
+Simulation* CreateTiledSimulation(BoardView const& initial, Options const& options)
+{
+	return new TiledSimulation(initial, options);
+}
@@ -0,0 +1,281 @@
+/******************************************************************************/
+/*!
+\file   trace.cpp
+\author Isaac Hill
+\par    email: Isaac.Hill@digipen.edu
+\par    DigiPen login: Isaac.Hill
+\par    Course: CS355
+\par    Assignment #1
+\date   1/21/2020
+\brief
+This is the Implementation file for the per thread phase tracer
+*/
+/******************************************************************************/
+
+#include "trace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+namespace
+{
+	size_t const kEventsPerRun = size_t(1) << 20; // shared between all rings
+	size_t const kMinRing = 64;
+	size_t const kMaxRing = size_t(1) << 16;
+
+	char const* const kPhaseNames[] = { "compute", "barrier", "write back", "lock" };
+}
+
+/******************************************************************************/
+/*!
+Creates a tracer with no rings, nothing is recorded until Start
+*/
+/******************************************************************************/
+Tracer::Tracer() : origin_(0)
+{
+}
+
+/******************************************************************************/
+/*!
+Sets up one ring per thread
+
+\param num_threads
+Number of threads that will record
+*/
+/******************************************************************************/
+void Tracer::Start(int num_threads)
+{
+	if (!kTraceEnabled)
+	{
+		return;
+	}
+
+	size_t const size = std::min(kMaxRing, std::max(kMinRing, kEventsPerRun / (num_threads > 0 ? num_threads : 1)));
+
+	rings_.resize(num_threads);
+	for (int i = 0; i < num_threads; ++i)
+	{
+		rings_[i].events.resize(size);
+		rings_[i].recorded = 0;
+		std::fill(rings_[i].totals, rings_[i].totals + kPhaseCount, 0);
+	}
+
+	origin_ = Now();
+}
+
+/******************************************************************************/
+/*!
+Sets up one total per phase and thread, with no ring to hold events
+
+\param num_threads
+Number of threads that will add to the totals
+*/
+/******************************************************************************/
+void Tracer::StartTotals(int num_threads)
+{
+	if (!kTraceEnabled)
+	{
+		return;
+	}
+
+	//Value initialized, so no events and every total at 0
+	rings_.assign(num_threads, Ring());
+
+	origin_ = Now();
+}
+
+/******************************************************************************/
+/*!
+Records one phase, overwriting the oldest event once the ring is full
+
+\param thread
+Index of the recording thread
+
+\param phase
+Phase that ended
+
+\param generation
+Generation it belonged to
+
+\param start, end
+When it started and ended, from Now
+*/
+/******************************************************************************/
+void Tracer::Record(int thread, Phase phase, int generation, uint64_t start, uint64_t end)
+{
+	if (static_cast<size_t>(thread) >= rings_.size())
+	{
+		return;
+	}
+
+	Ring& ring = rings_[thread];
+	ring.totals[static_cast<int>(phase)] += end - start;
+	if (ring.events.empty())
+	{
+		return;
+	}
+
+	Event& event = ring.events[ring.recorded % ring.events.size()];
+	event.start = start;
+	event.end = end;
+	event.generation = generation;
+	event.phase = phase;
+
+	++ring.recorded;
+}
+
+/******************************************************************************/
+/*!
+Adds time to a phase of a thread
+
+\param thread
+Index of the thread
+
+\param phase
+Phase the time was spent in
+
+\param nanoseconds
+Time to add
+*/
+/******************************************************************************/
+void Tracer::Add(int thread, Phase phase, uint64_t nanoseconds)
+{
+	if (static_cast<size_t>(thread) < rings_.size())
+	{
+		rings_[thread].totals[static_cast<int>(phase)] += nanoseconds;
+	}
+}
+
+/******************************************************************************/
+/*!
+Fills in the time spent in each phase, how uneven the compute time was
+between threads and the median and 99th percentile barrier wait
+
+\param stats
+Receives the summary
+*/
+/******************************************************************************/
+void Tracer::Summarize(Stats* stats) const
+{
+	if (rings_.empty())
+	{
+		return;
+	}
+
+	uint64_t totals[kPhaseCount] = {};
+	uint64_t max_compute = 0;
+	std::vector<uint64_t> waits;
+
+	for (unsigned i = 0; i < rings_.size(); ++i)
+	{
+		Ring const& ring = rings_[i];
+		for (int p = 0; p < kPhaseCount; ++p)
+		{
+			totals[p] += ring.totals[p];
+		}
+		max_compute = std::max(max_compute, ring.totals[static_cast<int>(Phase::kCompute)]);
+
+		size_t const kept = static_cast<size_t>(std::min<uint64_t>(ring.recorded, ring.events.size()));
+		for (size_t e = 0; e < kept; ++e)
+		{
+			if (ring.events[e].phase == Phase::kBarrier)
+			{
+				waits.push_back(ring.events[e].end - ring.events[e].start);
+			}
+		}
+	}
+
+	stats->compute_seconds = totals[static_cast<int>(Phase::kCompute)] * 1e-9;
+	stats->barrier_seconds = totals[static_cast<int>(Phase::kBarrier)] * 1e-9;
+	stats->write_back_seconds = totals[static_cast<int>(Phase::kWriteBack)] * 1e-9;
+	stats->lock_seconds = totals[static_cast<int>(Phase::kLock)] * 1e-9;
+
+	//The slowest thread decides when a generation ends
+	double const mean_compute = static_cast<double>(totals[static_cast<int>(Phase::kCompute)]) / rings_.size();
+	stats->imbalance = mean_compute > 0 ? max_compute / mean_compute : 0;
+
+	if (!waits.empty())
+	{
+		std::sort(waits.begin(), waits.end());
+		stats->barrier_p50_us = waits[waits.size() * 50 / 100] * 1e-3;
+		stats->barrier_p99_us = waits[waits.size() * 99 / 100] * 1e-3;
+	}
+}
+
+/******************************************************************************/
+/*!
+Writes the events as complete ("X") events of the Chrome trace format, one
+track per thread. A thread that only kept totals gets one event per phase
+as long as its total, laid end to end from the start. The file opens in
+chrome://tracing or Perfetto.
+
+\param path
+File to write
+*/
+/******************************************************************************/
+void Tracer::WriteChromeTrace(char const* path) const
+{
+	std::FILE* file = std::fopen(path, "w");
+	if (!file)
+	{
+		throw "cannot create trace file";
+	}
+
+	std::fprintf(file, "{\"traceEvents\":[");
+
+	bool first = true;
+	for (unsigned i = 0; i < rings_.size(); ++i)
+	{
+		Ring const& ring = rings_[i];
+		size_t const size = ring.events.size();
+		if (size == 0)
+		{
+			uint64_t start = 0;
+			for (int p = 0; p < kPhaseCount; ++p)
+			{
+				if (ring.totals[p])
+				{
+					std::fprintf(file, "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"total\":true}}",
+					             first ? "" : ",", kPhaseNames[p], i, start * 1e-3, ring.totals[p] * 1e-3);
+					start += ring.totals[p];
+					first = false;
+				}
+			}
+			continue;
+		}
+
+		uint64_t const begin = ring.recorded > size ? ring.recorded - size : 0;
+
+		//Oldest first
+		for (uint64_t n = begin; n < ring.recorded; ++n)
+		{
+			Event const& event = ring.events[n % size];
+			std::fprintf(file, "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"generation\":%d}}",
+			             first ? "" : ",", kPhaseNames[static_cast<int>(event.phase)], i,
+			             (event.start - origin_) * 1e-3, (event.end - event.start) * 1e-3, event.generation);
+			first = false;
+		}
+	}
+
+	std::fprintf(file, "\n]}\n");
+
+	if (std::fclose(file) != 0)
+	{
+		throw "cannot write trace file";
+	}
+}
+
+/******************************************************************************/
+/*!
+Current time for tracing
+
+\return
+Nanoseconds on the steady clock
+*/
+/******************************************************************************/
+uint64_t Tracer::Now()
+{
+	return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count());
+}
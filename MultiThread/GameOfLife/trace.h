@@ -0,0 +1,131 @@
+/******************************************************************************/
+/*!
+\file   trace.h
+\author Isaac Hill
+\par    email: Isaac.Hill@digipen.edu
+\par    DigiPen login: Isaac.Hill
+\par    Course: CS355
+\par    Assignment #1
+\date   1/21/2020
+\brief
+This is the Header file for the per thread phase tracer. Timing is only
+compiled in when GOL_TRACE is defined (make gcc0 DEFINE=-DGOL_TRACE),
+otherwise GOL_TRACE_PHASE expands to nothing and the step loops are
+unchanged.
+*/
+/******************************************************************************/
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "gol.h"
+
+#include <cstdint>
+#include <vector>
+
+// Parts of a generation a worker can be in
+enum class Phase
+{
+	kCompute,   // stepping its cells
+	kBarrier,   // waiting for the other workers
+	kWriteBack, // copying new states back into the shared board
+	kLock       // waiting for a lock every thread takes, only the per cell engine has one
+};
+
+int const kPhaseCount = 4;
+
+/******************************************************************************/
+/*!
+Per thread ring buffers of timed phases. Each thread only writes its own
+buffer, so recording needs no locks. Totals are kept outside the ring and
+never lose anything, percentiles come from the events still in the ring.
+*/
+/******************************************************************************/
+class Tracer
+{
+public:
+	Tracer();
+
+	// Sets up one ring per thread, the ring size shrinks as threads grow. Does
+	// nothing unless GOL_TRACE is defined
+	void Start(int num_threads);
+
+	// Sets up totals only, for threads too many to give each a ring. Does
+	// nothing unless GOL_TRACE is defined
+	void StartTotals(int num_threads);
+
+	void Record(int thread, Phase phase, int generation, uint64_t start, uint64_t end);
+
+	// Adds to the total of a phase without recording an event
+	void Add(int thread, Phase phase, uint64_t nanoseconds);
+
+	// Fills the instrumentation fields of stats
+	void Summarize(Stats* stats) const;
+
+	// Writes every event still in the rings as Chrome trace JSON
+	void WriteChromeTrace(char const* path) const;
+
+	static uint64_t Now();
+
+private:
+	struct Event
+	{
+		uint64_t start; // nanoseconds
+		uint64_t end;
+		int generation;
+		Phase phase;
+	};
+
+	struct Ring
+	{
+		std::vector<Event> events;
+		uint64_t recorded;             // events ever recorded, the next slot is recorded % size
+		uint64_t totals[kPhaseCount];  // nanoseconds per phase
+		char pad[64];                  // keeps the threads' counters off each other's cache lines
+	};
+
+	std::vector<Ring> rings_;
+	uint64_t origin_; // time Start was called, events are written relative to it
+};
+
+/******************************************************************************/
+/*!
+Times the scope it lives in and records it as one phase
+*/
+/******************************************************************************/
+class PhaseTimer
+{
+public:
+	PhaseTimer(Tracer* tracer, int thread, Phase phase, int generation)
+		: tracer_(tracer), thread_(thread), phase_(phase), generation_(generation), start_(Tracer::Now())
+	{
+	}
+
+	~PhaseTimer()
+	{
+		if (tracer_)
+		{
+			tracer_->Record(thread_, phase_, generation_, start_, Tracer::Now());
+		}
+	}
+
+private:
+	PhaseTimer(PhaseTimer const&);
+	PhaseTimer& operator=(PhaseTimer const&);
+
+	Tracer* tracer_;
+	int thread_;
+	Phase phase_;
+	int generation_;
+	uint64_t start_;
+};
+
+#ifdef GOL_TRACE
+bool const kTraceEnabled = true;
+#define GOL_TRACE_PHASE(tracer, thread, phase, generation) PhaseTimer gol_phase_timer((tracer), (thread), (phase), (generation))
+#else
+bool const kTraceEnabled = false;
+#define GOL_TRACE_PHASE(tracer, thread, phase, generation)
+#endif
+
+#endif
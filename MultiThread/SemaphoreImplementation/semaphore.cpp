@@ -8,7 +8,9 @@
 \par    Assignment #2
 \date   2/11/2020
 \brief
-This is the Implementation file for a semaphore using mutexes
+This is the Implementation file for a semaphore with an atomic fast path.
+Taking a free permit or giving one back when nobody waits is a single atomic
+operation, only a thread that finds no permit touches the mutex.
 */
 /******************************************************************************/
 
@@ -16,19 +18,42 @@ This is the Implementation file for a semaphore using mutexes
 
 void Semaphore::wait()
 {
-	std::unique_lock<std::mutex> lk(cv_m_);
-	//std::cerr << "Count is " << count << "\n"; // Debug Output
+	//Take a free permit, or count ourselves as a waiter in the same word
+	uint64_t state = state_.load(std::memory_order_relaxed);
+	for (;;)
+	{
+		if (Permits(state) > 0)
+		{
+			if (state_.compare_exchange_weak(state, state - kPermit, std::memory_order_acquire, std::memory_order_relaxed))
+				return;
+		}
+		else if (state_.compare_exchange_weak(state, state + kWaiter, std::memory_order_relaxed, std::memory_order_relaxed))
+			break;
+	}
 
-	if(count_ > -1)
-		--count_;
+	//A signal that sees us counted notifies under the lock, and we check for a
+	//permit under the same lock before sleeping, so no wake up is lost
+	std::unique_lock<std::mutex> lk(cv_m_);
+	for (;;)
+	{
+		state = state_.load(std::memory_order_relaxed);
+		while (Permits(state) > 0)
+		{
+			if (state_.compare_exchange_weak(state, state - kPermit - kWaiter, std::memory_order_acquire, std::memory_order_relaxed))
+				return;
+		}
 
-	cv_.wait(lk, [this] {return count_ >= 0; });
+		cv_.wait(lk);
+	}
 }
 
 void Semaphore::signal()
 {
-	std::unique_lock<std::mutex> lk(cv_m_);
+	uint64_t const state = state_.fetch_add(kPermit, std::memory_order_release);
 
-	++count_;
-	cv_.notify_one();
-}
\ No newline at end of file
+	if (Waiters(state) > 0)
+	{
+		std::lock_guard<std::mutex> lk(cv_m_);
+		cv_.notify_one();
+	}
+}
@@ -8,26 +8,36 @@
 \par    Assignment #2
 \date   2/11/2020
 \brief
-This is the Header file for a semaphore implementation using mutexes
+This is the Header file for a semaphore implementation using an atomic fast
+path with a mutex and condition variable for the threads that must block
 */
 /******************************************************************************/
 
 #pragma once
 
+#include <atomic>
 #include <condition_variable>
+#include <cstdint>
 #include <mutex>
 #include <iostream>
 
 class Semaphore
 {
 public:
-	Semaphore(int init_count) : count_(init_count) {}
+	Semaphore(int init_count) : state_(static_cast<uint64_t>(init_count > 0 ? init_count : 0)) {}
 
 	void wait();
 	void signal();
 
 private:
-	int count_;
+	// Low 32 bits are the free permits, high 32 bits the threads blocked or about to block
+	static uint64_t const kPermit = 1;
+	static uint64_t const kWaiter = uint64_t(1) << 32;
+
+	static uint64_t Permits(uint64_t state) { return state & (kWaiter - 1); }
+	static uint64_t Waiters(uint64_t state) { return state >> 32; }
+
+	std::atomic<uint64_t> state_;
 	std::mutex cv_m_;
 	std::condition_variable cv_;
-};
\ No newline at end of file
+};